@@ -0,0 +1,124 @@
+// Simulates the shared I2C bus of the meter: the SH1106 driver of lib/u8g2 and
+// INA226 reads of the firmware's size go through src/i2c_bus.cpp onto a
+// simulated Wire, where every transaction takes its bit time at the current
+// clock. Reports how late the 5 ms sensor polls start, with and without the
+// sensor preempting display transfers, and checks the guarantee of
+// i2c_bus.h: with preemption a due poll waits for at most one display
+// transaction.
+//
+//   bus_sim [<sensor_clock_hz>]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Wire.h"
+#include "i2c_bus.h"
+#include "sim.h"
+
+#define POLL_US 5000
+#define FRAME_US 150000
+#define SIM_US 10000000
+#define INA_REGISTER_READS 5 // read_ina(): flags, shunt, bus, current, power
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+static uint8_t sensor;
+static double next_poll;
+static double late_max, late_sum;
+static unsigned long polls;
+
+// the bus part of read_ina()
+static void poll_sensor() {
+  if (sim_us < next_poll)
+    return;
+  double late = sim_us - next_poll;
+  late_max = std::max(late_max, late);
+  late_sum += late;
+  polls++;
+  bus_begin(sensor);
+  for (int i = 0; i < INA_REGISTER_READS; i++) {
+    Wire.beginTransmission(0x40);
+    Wire.write(static_cast<uint8_t>(i));
+    Wire.endTransmission(false);
+    Wire.requestFrom(0x40, 2);
+  }
+  bus_end(sensor);
+  next_poll += POLL_US;
+  if (next_poll < sim_us)
+    next_poll = sim_us;
+}
+
+struct Result {
+  double late_max, late_mean;
+  uint32_t display_max_us;
+};
+
+// Sends a full frame every FRAME_US, in tile_rows_per_step rows between the
+// polls of the main loop.
+static Result run(u8x8_t *u8x8, uint8_t tile_rows_per_step, bool preempt) {
+  static uint8_t tiles[16 * 8];
+  sim_us = 0;
+  next_poll = 0;
+  late_max = late_sum = 0;
+  polls = 0;
+  bus_clear_stats();
+  bus_set_service(sensor, preempt ? poll_sensor : nullptr);
+
+  double next_frame = 0;
+  uint8_t row = 8; // no frame pending
+  while (sim_us < SIM_US) {
+    poll_sensor();
+    if (row < 8) {
+      for (uint8_t n = 0; n < tile_rows_per_step && row < 8; n++, row++)
+        u8x8_DrawTile(u8x8, 0, row, 16, tiles);
+    } else if (sim_us >= next_frame) {
+      next_frame += FRAME_US;
+      row = 0;
+    } else {
+      sim_us = std::min(next_poll, next_frame); // idle
+    }
+  }
+  bus_set_service(sensor, nullptr);
+  uint8_t display = sensor == 0 ? 1 : 0;
+  return {late_max, polls ? late_sum / polls : 0, bus_device_stats(display).max_us};
+}
+
+int main(int argc, char **argv) {
+  static u8x8_t u8x8;
+  uint32_t sensor_clock = argc > 1 ? strtoul(argv[1], nullptr, 0) : 400000;
+  u8x8_Setup(&u8x8, u8x8_d_sh1106_128x64_noname, u8x8_cad_sh1106_fast_i2c,
+             u8x8_byte_bus_i2c, gpio_none);
+  u8x8_InitDisplay(&u8x8);
+  sensor = bus_add_device("sensor", sensor_clock, 1);
+
+  printf("display %lu Hz, sensor %lu Hz, poll every %d us, frame every %d us\n",
+         static_cast<unsigned long>(u8x8.bus_clock),
+         static_cast<unsigned long>(sensor_clock), POLL_US, FRAME_US);
+  bool ok = true;
+  for (uint8_t rows : {8, 1}) {
+    for (bool preempt : {false, true}) {
+      Result r = run(&u8x8, rows, preempt);
+      printf("%u tile rows per step, %-10s poll late max %6.0f us mean %5.0f us",
+             rows, preempt ? "preempt" : "no preempt", r.late_max, r.late_mean);
+      for (uint8_t i = 0; i < bus_device_count(); i++) {
+        const bus_stats &st = bus_device_stats(i);
+        printf("  %s %4.1f%%", bus_device_name(i), st.busy_us * 100.0 / SIM_US);
+      }
+      printf("  clock switches %lu\n",
+             static_cast<unsigned long>(bus_clock_switches()));
+      // a poll may also become due during another poll's own transactions
+      if (preempt && r.late_max > r.display_max_us + 1) {
+        printf("  FAILED: late by more than one display transaction (%lu us)\n",
+               static_cast<unsigned long>(r.display_max_us));
+        ok = false;
+      }
+    }
+  }
+  if (sim_wire_overflows != 0) {
+    printf("FAILED: %lu writes beyond the Wire buffer\n",
+           static_cast<unsigned long>(sim_wire_overflows));
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include "clock_sync.h"
+
+#include <cmath>
+
+ClockSync::ClockSync(uint64_t bucket_us, size_t max_buckets)
+    : bucket_us_(bucket_us ? bucket_us : 1), max_buckets_(max_buckets < 2 ? 2 : max_buckets) {}
+
+void ClockSync::reset() {
+  points_.clear();
+  fitted_ = false;
+  error_ns_ = 0.0;
+}
+
+void ClockSync::add(uint64_t device_us, int64_t host_ns) {
+  uint64_t bucket = device_us / bucket_us_;
+
+  if (!points_.empty() && points_.back().bucket == bucket) {
+    // same bucket: keep the observation with the least transport delay
+    Point &p = points_.back();
+    double delay_new = host_ns - static_cast<double>(device_us) * 1000.0;
+    double delay_old = p.host_ns - static_cast<double>(p.device_us) * 1000.0;
+    if (delay_new < delay_old) {
+      p.device_us = device_us;
+      p.host_ns = host_ns;
+      refit();
+    }
+    return;
+  }
+  if (!points_.empty() && bucket < points_.back().bucket) {
+    // meter restarted, its old timeline is useless
+    reset();
+  }
+  points_.push_back({bucket, device_us, host_ns});
+  if (points_.size() > max_buckets_)
+    points_.erase(points_.begin());
+  refit();
+}
+
+void ClockSync::refit() {
+  size_t n = points_.size();
+  if (n < 2) {
+    fitted_ = false;
+    return;
+  }
+  x0_ = points_.front().device_us;
+  y0_ = points_.front().host_ns;
+
+  std::vector<bool> use(n, true);
+  double slope = 1000.0, offset = 0.0;
+
+  // Least squares, then drop everything above the line and fit again. Points
+  // above the line carry more delay than the envelope; a few passes converge
+  // on the lower envelope.
+  for (int pass = 0; pass < 4; pass++) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (!use[i])
+        continue;
+      double x = static_cast<double>(points_[i].device_us - x0_);
+      double y = static_cast<double>(points_[i].host_ns - y0_);
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+      m++;
+    }
+    double den = m * sxx - sx * sx;
+    if (m < 2 || den == 0.0)
+      break;
+    slope = (m * sxy - sx * sy) / den;
+    offset = (sy - slope * sx) / m;
+
+    size_t below = 0;
+    std::vector<bool> next(n, false);
+    for (size_t i = 0; i < n; i++) {
+      double x = static_cast<double>(points_[i].device_us - x0_);
+      double y = static_cast<double>(points_[i].host_ns - y0_);
+      next[i] = use[i] && y <= slope * x + offset;
+      below += next[i];
+    }
+    if (below < 2 || below == m)
+      break;
+    use.swap(next);
+  }
+
+  // Shift the line down onto the lowest observation so that no kept minimum
+  // lies below it, then report the spread above it as the error bound.
+  double lowest = 0.0, highest = 0.0;
+  bool first = true;
+  for (size_t i = 0; i < n; i++) {
+    if (!use[i])
+      continue;
+    double x = static_cast<double>(points_[i].device_us - x0_);
+    double r = static_cast<double>(points_[i].host_ns - y0_) - (slope * x + offset);
+    if (first || r < lowest)
+      lowest = r;
+    if (first || r > highest)
+      highest = r;
+    first = false;
+  }
+  slope_ = slope;
+  offset_ = offset + lowest;
+  error_ns_ = highest - lowest;
+  fitted_ = true;
+}
+
+int64_t ClockSync::to_host_ns(uint64_t device_us) const {
+  double x = static_cast<double>(static_cast<int64_t>(device_us - x0_));
+  return y0_ + static_cast<int64_t>(std::llround(slope_ * x + offset_));
+}
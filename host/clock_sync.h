@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Maps meter time (unwrapped micros(), see TimestampUnwrapper) to host
+// monotonic time in nanoseconds.
+//
+// Every sample is observed as (device_us, host_ns) where host_ns includes a
+// non-negative, jittery transport delay. Per bucket of device time only the
+// observation with the smallest delay is kept; the line is then fitted to the
+// lower envelope of those minima. error_bound_ns() is the largest deviation
+// of any kept minimum from the fitted line.
+class ClockSync {
+public:
+  explicit ClockSync(uint64_t bucket_us = 1000000, size_t max_buckets = 600);
+
+  void add(uint64_t device_us, int64_t host_ns);
+  void reset();
+
+  // At least two buckets are needed for a fit.
+  bool ready() const { return fitted_; }
+
+  int64_t to_host_ns(uint64_t device_us) const;
+  // Relative rate error of the meter clock in parts per million.
+  double drift_ppm() const { return (slope_ - 1000.0) / 1000.0 * 1e6; }
+  double error_bound_ns() const { return error_ns_; }
+
+private:
+  struct Point {
+    uint64_t bucket;
+    uint64_t device_us;
+    int64_t host_ns;
+  };
+
+  void refit();
+
+  uint64_t bucket_us_;
+  size_t max_buckets_;
+  std::vector<Point> points_; // oldest first, one per bucket
+
+  bool fitted_ = false;
+  uint64_t x0_ = 0; // fit origin, keeps the doubles small
+  int64_t y0_ = 0;
+  double slope_ = 1000.0; // host ns per device us
+  double offset_ = 0.0;
+  double error_ns_ = 0.0;
+};
@@ -0,0 +1,151 @@
+// Checks TimestampUnwrapper (meter_protocol.h) and ClockSync (clock_sync.h)
+// with generated meter timestamps: a wrap of micros(), restarts of the meter
+// before and after a wrap, reset(), and a meter clock that drifts against the
+// host, with a jittery transport delay, across a wrap and a restart. Prints
+// the fitted drift and the largest mapping error and exits non-zero if one of
+// them is off.
+//
+//   clock_sync_check
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "clock_sync.h"
+#include "meter_protocol.h"
+
+// every sample arrives at least this late, jitter comes on top
+#define BASE_DELAY_NS 200000
+#define JITTER_NS 5000000
+#define SAMPLE_US 10000
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static bool ok = true;
+
+static void expect(bool cond, const char *what) {
+  if (!cond && ok) {
+    printf("FAILED: %s\n", what);
+    ok = false;
+  }
+}
+
+static void check_unwrapper() {
+  TimestampUnwrapper u;
+  // 50 ms steps across the wrap count on
+  uint32_t t = 0xffffffffu - 120000;
+  uint64_t last = u.extend(t);
+  for (int i = 0; i < 10; i++) {
+    t += 50000;
+    uint64_t v = u.extend(t);
+    expect(v == last + 50000 && !u.restarted(), "wrap");
+    last = v;
+  }
+  expect(last >> 32 == 1, "wrap sets the high word");
+
+  // the longest step that still counts as a wrap, and one longer
+  u.reset();
+  u.extend(0xffffffffu - 1000);
+  expect(u.extend(TIMESTAMP_MAX_STEP_US - 1001) == (1ULL << 32) + TIMESTAMP_MAX_STEP_US - 1001 &&
+             !u.restarted(),
+         "longest wrap");
+  u.reset();
+  u.extend(0xffffffffu - 1000);
+  expect(u.extend(TIMESTAMP_MAX_STEP_US) == TIMESTAMP_MAX_STEP_US && u.restarted(),
+         "step over the wrap longer than a sample gap");
+
+  // a restart after a wrap starts the count again
+  u.reset();
+  u.extend(0xffffffffu - 1000);
+  u.extend(2000000000u);
+  expect(u.extend(1500000) == 1500000 && u.restarted(), "restart after a wrap");
+  expect(u.extend(1550000) == 1550000 && !u.restarted(), "after a restart");
+
+  // a step back in the middle of the range is a restart, not a wrap
+  u.reset();
+  u.extend(2000000000u);
+  expect(u.extend(1900000000u) == 1900000000u && u.restarted(), "step back");
+
+  // reset() forgets the high word
+  u.reset();
+  u.extend(0xffffffffu);
+  u.extend(10);
+  u.reset();
+  expect(u.extend(5) == 5 && !u.restarted(), "reset");
+}
+
+// A meter clock at ppm against the host, with micros() at start_us when the
+// host is at host0_ns.
+struct Meter {
+  double ppm;
+  uint32_t start_us;
+  int64_t host0_ns;
+
+  // host time of the reading taken elapsed_us of meter time after the start
+  int64_t host_ns(uint64_t elapsed_us) const {
+    return host0_ns + std::llround(elapsed_us * 1000.0 * (1 + ppm * 1e-6));
+  }
+};
+
+// Feeds seconds of samples of m through u into sync. Returns the largest
+// error of the mapped time over the last half, after the fit has settled.
+static double run(TimestampUnwrapper &u, ClockSync &sync, const Meter &m,
+                  unsigned seconds, bool *restarted) {
+  double max_error = 0;
+  *restarted = false;
+  unsigned samples = seconds * (1000000 / SAMPLE_US);
+  for (unsigned i = 0; i < samples; i++) {
+    uint64_t elapsed = static_cast<uint64_t>(i) * SAMPLE_US;
+    uint64_t device_us = u.extend(m.start_us + static_cast<uint32_t>(elapsed));
+    *restarted |= u.restarted();
+    int64_t true_ns = m.host_ns(elapsed);
+    // one sample in 20 arrives with the least delay
+    int64_t delay = BASE_DELAY_NS + (random_next() % 20 ? random_next() % JITTER_NS : 0);
+    sync.add(device_us, true_ns + delay);
+    if (i >= samples / 2 && sync.ready()) {
+      double error = std::fabs(static_cast<double>(sync.to_host_ns(device_us) -
+                                                   (true_ns + BASE_DELAY_NS)));
+      if (error > max_error)
+        max_error = error;
+    }
+  }
+  return max_error;
+}
+
+static void check_clock_sync() {
+  TimestampUnwrapper u;
+  ClockSync sync;
+  bool restarted;
+
+  // drifting meter whose micros() wraps after 30 s
+  Meter m{42.0, 0xffffffffu - 30000000, 1000000000000LL};
+  double error = run(u, sync, m, 120, &restarted);
+  printf("drift %+.1f ppm, fitted %+.2f ppm, max error %.0f us, bound %.0f us\n",
+         m.ppm, sync.drift_ppm(), error / 1000, sync.error_bound_ns() / 1000);
+  expect(!restarted, "wrap taken for a restart");
+  expect(std::fabs(sync.drift_ppm() - m.ppm) < 1, "drift across the wrap");
+  expect(error < 50000, "mapping across the wrap");
+
+  // the meter restarts 2 s later with another drift; the fit starts over
+  Meter r{-17.0, 0, m.host_ns(120000000) + 2000000000LL};
+  error = run(u, sync, r, 120, &restarted);
+  printf("restart at %+.1f ppm, fitted %+.2f ppm, max error %.0f us\n", r.ppm,
+         sync.drift_ppm(), error / 1000);
+  expect(restarted, "restart not detected");
+  expect(std::fabs(sync.drift_ppm() - r.ppm) < 1, "drift after the restart");
+  expect(error < 50000, "mapping after the restart");
+}
+
+int main() {
+  check_unwrapper();
+  check_clock_sync();
+  return ok ? 0 : 1;
+}
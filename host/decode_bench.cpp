@@ -0,0 +1,226 @@
+// Compares u8g2_font_decode_len_direct(), the glyph decoder of lib/u8g2 that
+// writes fully visible R0 glyphs straight into a vertical_top_lsb buffer,
+// with the general path through u8g2_DrawHVLine() it bypasses, and prints the
+// drawStr() throughput of both. Exits non-zero if a buffer differs.
+//
+// The general path is a second u8g2 with its own buffer whose ll_hvline
+// calls u8g2_ll_hvline_vertical_top_lsb() through a wrapper: the buffer is
+// the same, but u8g2_font_is_direct() sees another procedure and decodes
+// every glyph with clipping. Both start from the same random content.
+//
+// Checked are strings at every position around the display edges, where a
+// glyph is inside, touching or one pixel over the border, with all draw
+// colors and both font modes; then random strings around the edges of clip
+// windows and in a page buffer.
+//
+// Build without U8G2_WITH_GLYPH_CACHE: cached glyphs never reach the
+// decoder. The profont data comes from u8g2_fonts.c.
+//
+//   decode_bench [<strings>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "clib/u8g2.h"
+}
+
+#ifdef U8G2_WITH_GLYPH_CACHE
+#error "build without U8G2_WITH_GLYPH_CACHE"
+#endif
+#ifndef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+#error "the direct decoder needs U8G2_WITH_HVLINE_SPEED_OPTIMIZATION"
+#endif
+
+#define WIDTH 128
+#define HEIGHT 64
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+static void ll_hvline_general(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
+                              u8g2_uint_t len, uint8_t dir) {
+  u8g2_ll_hvline_vertical_top_lsb(u8g2, x, y, len, dir);
+}
+
+static const uint8_t *const fonts[] = {
+    u8g2_font_profont10_tr, u8g2_font_profont12_tr, u8g2_font_profont17_tr,
+    u8g2_font_profont29_tr};
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+struct Pair {
+  u8g2_t direct, general;
+  size_t size; // buffer bytes
+  uint8_t content[WIDTH * HEIGHT / 8];
+  uint8_t direct_buf[WIDTH * HEIGHT / 8];
+  uint8_t general_buf[WIDTH * HEIGHT / 8];
+};
+
+static void setup(Pair &p, bool page_buffer) {
+  if (page_buffer) {
+    u8g2_Setup_sh1106_i2c_128x64_noname_1(&p.direct, U8G2_R0, u8x8_byte_empty, gpio_none);
+    u8g2_Setup_sh1106_i2c_128x64_noname_1(&p.general, U8G2_R0, u8x8_byte_empty, gpio_none);
+  } else {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&p.direct, U8G2_R0, u8x8_byte_empty, gpio_none);
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&p.general, U8G2_R0, u8x8_byte_empty, gpio_none);
+  }
+  p.direct.tile_buf_ptr = p.direct_buf;
+  p.general.tile_buf_ptr = p.general_buf;
+  p.general.ll_hvline = ll_hvline_general;
+  p.size = u8g2_GetBufferTileWidth(&p.direct) * 8 * u8g2_GetBufferTileHeight(&p.direct);
+  for (size_t i = 0; i < p.size; i++)
+    p.content[i] = static_cast<uint8_t>(random_next());
+}
+
+// Applies fn to both u8g2.
+template <typename Fn> static void both(Pair &p, Fn fn) {
+  fn(&p.direct);
+  fn(&p.general);
+}
+
+static bool ok = true;
+static unsigned long checks = 0;
+
+// Draws s at x, y into both from the same content and compares the buffers.
+static void compare(Pair &p, const char *what, u8g2_uint_t x, u8g2_uint_t y,
+                    const char *s) {
+  memcpy(p.direct.tile_buf_ptr, p.content, p.size);
+  memcpy(p.general.tile_buf_ptr, p.content, p.size);
+  u8g2_uint_t dx = u8g2_DrawStr(&p.direct, x, y, s);
+  u8g2_uint_t general_dx = u8g2_DrawStr(&p.general, x, y, s);
+  checks++;
+  if ((dx != general_dx || memcmp(p.direct.tile_buf_ptr, p.general.tile_buf_ptr, p.size) != 0) &&
+      ok) {
+    printf("FAILED: %s \"%s\" at %d,%d\n", what, s, static_cast<int16_t>(x),
+           static_cast<int16_t>(y));
+    ok = false;
+  }
+}
+
+static void random_string(char *buf, size_t max_len) {
+  size_t len = 1 + random_next() % max_len;
+  for (size_t i = 0; i < len; i++)
+    buf[i] = ' ' + random_next() % 95;
+  buf[len] = '\0';
+}
+
+// Every x and baseline where a glyph crosses an edge of the display, in
+// every font, draw color and font mode.
+static void check_edges(Pair &p) {
+  char what[64];
+  char s[4];
+  for (unsigned n = 0; n < sizeof(fonts) / sizeof(fonts[0]); n++) {
+    both(p, [&](u8g2_t *u) { u8g2_SetFont(u, fonts[n]); });
+    int max_w = u8g2_GetMaxCharWidth(&p.direct);
+    int ascent = u8g2_GetAscent(&p.direct), descent = u8g2_GetDescent(&p.direct);
+    for (uint8_t color = 0; color <= 2; color++) {
+      for (uint8_t transparent = 0; transparent <= 1; transparent++) {
+        both(p, [&](u8g2_t *u) {
+          u8g2_SetDrawColor(u, color);
+          u8g2_SetFontMode(u, transparent);
+        });
+        snprintf(what, sizeof(what), "font %u color %u mode %u", n, color, transparent);
+        for (int y = -descent - 2; y <= HEIGHT + ascent + 2; y++) {
+          bool y_edge = y < ascent + 2 || y > HEIGHT + descent - 2;
+          for (int x = -max_w - 1; x <= WIDTH + 1; x++) {
+            bool x_edge = x < 2 || x > WIDTH - 2 * max_w - 2;
+            if (!x_edge && !y_edge)
+              continue;
+            random_string(s, 2);
+            compare(p, what, static_cast<u8g2_uint_t>(x), static_cast<u8g2_uint_t>(y), s);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Random strings around the edges of random clip windows; in a page buffer
+// each page is a window of its own.
+static void check_random(Pair &p, unsigned count, bool page_buffer) {
+  char what[64];
+  char s[8];
+  for (unsigned i = 0; i < count; i++) {
+    unsigned n = random_next() % (sizeof(fonts) / sizeof(fonts[0]));
+    uint8_t color = random_next() % 3, transparent = random_next() % 2;
+    // not empty, see fill_bench
+    u8g2_uint_t cx0 = random_next() % WIDTH, cy0 = random_next() % HEIGHT;
+    u8g2_uint_t cx1 = cx0 + 1 + random_next() % (WIDTH - cx0);
+    u8g2_uint_t cy1 = cy0 + 1 + random_next() % (HEIGHT - cy0);
+    bool clip = random_next() % 4 != 0;
+    both(p, [&](u8g2_t *u) {
+      u8g2_SetFont(u, fonts[n]);
+      u8g2_SetDrawColor(u, color);
+      u8g2_SetFontMode(u, transparent);
+      if (clip)
+        u8g2_SetClipWindow(u, cx0, cy0, cx1, cy1);
+      else
+        u8g2_SetMaxClipWindow(u);
+    });
+    int reach = 2 * u8g2_GetMaxCharWidth(&p.direct);
+    int x = (random_next() % 2 ? cx0 : cx1) + static_cast<int>(random_next() % (2 * reach)) - reach;
+    int y = (random_next() % 2 ? cy0 : cy1) + static_cast<int>(random_next() % 40) - 10;
+    random_string(s, 6);
+    uint8_t rows = page_buffer ? HEIGHT / 8 : 1;
+    for (uint8_t row = 0; row < rows; row++) {
+      if (page_buffer)
+        both(p, [&](u8g2_t *u) { u8g2_SetBufferCurrTileRow(u, row); });
+      snprintf(what, sizeof(what), "%s font %u color %u mode %u row %u",
+               clip ? "clipped" : "unclipped", n, color, transparent, row);
+      compare(p, what, static_cast<u8g2_uint_t>(x), static_cast<u8g2_uint_t>(y), s);
+    }
+  }
+  both(p, [](u8g2_t *u) {
+    u8g2_SetMaxClipWindow(u);
+    u8g2_SetDrawColor(u, 1);
+    u8g2_SetFontMode(u, 0);
+  });
+}
+
+// Glyphs per second of drawStr() of a reading in the middle of the display,
+// where every glyph of the fonts is fully visible, best of five runs.
+static double glyph_rate(u8g2_t *u, unsigned strings) {
+  static const char reading[] = "12.345";
+  double best = 0;
+  for (int run = 0; run < 5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      u8g2_DrawStr(u, 0, 40, reading);
+    std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+    double rate = strings * (sizeof(reading) - 1) / t.count();
+    if (rate > best)
+      best = rate;
+  }
+  return best;
+}
+
+int main(int argc, char **argv) {
+  unsigned strings = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+  static Pair full, page;
+  setup(full, false);
+  setup(page, true);
+
+  check_edges(full);
+  check_random(full, 200000, false);
+  check_random(page, 20000, true);
+  printf("%lu strings compared\n", checks);
+
+  printf("drawStr(\"12.345\")   general      direct\n");
+  for (unsigned n = 0; n < sizeof(fonts) / sizeof(fonts[0]); n++) {
+    both(full, [&](u8g2_t *u) { u8g2_SetFont(u, fonts[n]); });
+    double general = glyph_rate(&full.general, strings);
+    double direct = glyph_rate(&full.direct, strings);
+    printf("  %2d px font  %7.0f kglyph/s %7.0f kglyph/s\n",
+           u8g2_GetMaxCharHeight(&full.direct), general / 1000, direct / 1000);
+  }
+  return ok ? 0 : 1;
+}
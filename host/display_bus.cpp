@@ -0,0 +1,110 @@
+// Measures the I2C traffic of the display driver. Frames are sent through the
+// SH1106 driver of lib/u8g2 into a byte procedure that only counts
+// transactions and bytes, once with the stock ssd13xx fast I2C procedure and
+// once with the SH1106 one of the firmware, which sends the commands with the
+// data.
+//
+//   display_bus [<max_transfer> ...]   bytes the transport takes per
+//                                      transaction (default: 32 128 255)
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "u8x8.h"
+}
+
+struct BusCount {
+  unsigned long transactions = 0;
+  unsigned long bytes = 0;     // after the address byte
+  unsigned long overflows = 0; // transactions longer than max_transfer
+};
+
+static BusCount bus;
+static uint8_t max_transfer;
+static unsigned long txn_bytes;
+
+// I2C bus time in bit clocks: start, address + ack, 9 clocks per byte, stop.
+static unsigned long bus_bits(const BusCount &c) {
+  return c.transactions * (1 + 9 + 1) + c.bytes * 9;
+}
+
+static uint8_t byte_count(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *) {
+  switch (msg) {
+  case U8X8_MSG_BYTE_INIT:
+    u8x8->i2c_max_transfer = max_transfer;
+    break;
+  case U8X8_MSG_BYTE_START_TRANSFER:
+    txn_bytes = 0;
+    break;
+  case U8X8_MSG_BYTE_SEND:
+    txn_bytes += arg_int;
+    break;
+  case U8X8_MSG_BYTE_END_TRANSFER:
+    bus.transactions++;
+    bus.bytes += txn_bytes;
+    if (txn_bytes > max_transfer)
+      bus.overflows++;
+    break;
+  case U8X8_MSG_BYTE_SET_DC:
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+static void report(const char *what, const BusCount &c, unsigned n) {
+  printf("  %-18s %7.1f transactions %9.1f bytes %9.1f bus bits%s\n", what,
+         static_cast<double>(c.transactions) / n,
+         static_cast<double>(c.bytes) / n,
+         static_cast<double>(bus_bits(c)) / n,
+         c.overflows ? "  TRANSPORT OVERFLOW" : "");
+}
+
+static bool measure(const char *name, u8x8_msg_cb cad, uint8_t max) {
+  static u8x8_t u8x8;
+  static uint8_t tiles[16 * 8];
+  max_transfer = max;
+  u8x8_Setup(&u8x8, u8x8_d_sh1106_128x64_noname, cad, byte_count, gpio_none);
+  u8x8_InitDisplay(&u8x8);
+  bus = BusCount();
+
+  printf("%s, max_transfer %u\n", name, max);
+  const unsigned frames = 10;
+  for (unsigned f = 0; f < frames; f++)
+    for (uint8_t row = 0; row < 8; row++)
+      u8x8_DrawTile(&u8x8, 0, row, 16, tiles);
+  report("full frame", bus, frames);
+  bool ok = bus.overflows == 0;
+
+  // what u8g2_UpdateDisplayDiff() sends for a short run of changed tiles
+  bus = BusCount();
+  for (unsigned f = 0; f < frames; f++)
+    u8x8_DrawTile(&u8x8, 5, 3, 3, tiles);
+  report("3 tile update", bus, frames);
+  return ok && bus.overflows == 0;
+}
+
+int main(int argc, char **argv) {
+  std::vector<unsigned> sizes;
+  for (int i = 1; i < argc; i++)
+    sizes.push_back(strtoul(argv[i], nullptr, 0));
+  if (sizes.empty())
+    sizes = {32, 128, 255};
+  bool ok = true;
+  for (unsigned s : sizes) {
+    if (s < 16 || s > 255) {
+      fprintf(stderr, "max_transfer must be 16..255\n");
+      return 2;
+    }
+    ok = measure("u8x8_cad_ssd13xx_fast_i2c", u8x8_cad_ssd13xx_fast_i2c,
+                 static_cast<uint8_t>(s)) && ok;
+    ok = measure("u8x8_cad_sh1106_fast_i2c", u8x8_cad_sh1106_fast_i2c,
+                 static_cast<uint8_t>(s)) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// Counts the I2C bytes of u8g2_UpdateDisplayDiff() and
+// u8g2_UpdateDisplayDiffStep() (lib/u8g2/clib/u8g2_buffer.c) for the SH1106
+// of the firmware, with the transport buffer of the ESP8266 Wire library
+// (128 bytes). Frames go through the SH1106 driver and the SH1106 fast I2C
+// procedure of the firmware into a byte procedure that counts transactions and bytes, like
+// display_bus. Exits non-zero if a count differs from the expected one.
+//
+//   display_diff
+//
+// A run of n adjacent changed tiles in a tile row is one u8x8_DrawTile(): the
+// start line, column and page commands (4 x 2 bytes with their control
+// bytes), one data control byte and 8n data bytes, in one transaction as long
+// as they fit into 127 bytes. A longer run continues in a new transaction
+// with another control byte.
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include "clib/u8g2.h"
+}
+
+#define MAX_TRANSFER 128
+
+struct BusCount {
+  unsigned long transactions = 0;
+  unsigned long bytes = 0; // after the address byte
+};
+
+static BusCount bus;
+static unsigned long txn_bytes;
+
+static uint8_t byte_count(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *) {
+  switch (msg) {
+  case U8X8_MSG_BYTE_INIT:
+    u8x8->i2c_max_transfer = MAX_TRANSFER;
+    break;
+  case U8X8_MSG_BYTE_START_TRANSFER:
+    txn_bytes = 0;
+    break;
+  case U8X8_MSG_BYTE_SEND:
+    txn_bytes += arg_int;
+    break;
+  case U8X8_MSG_BYTE_END_TRANSFER:
+    bus.transactions++;
+    bus.bytes += txn_bytes;
+    break;
+  case U8X8_MSG_BYTE_SET_DC:
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+// A seven segment digit in a 16 x 29 cell, the size of a profont29 digit.
+// Segments a..g are bits 0..6.
+static void draw_digit(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t top, char c) {
+  static const uint8_t segments[10] = {0x3f, 0x06, 0x5b, 0x4f, 0x66,
+                                       0x6d, 0x7d, 0x07, 0x7f, 0x6f};
+  if (c == '.') {
+    u8g2_DrawBox(u8g2, x + 6, top + 26, 3, 3);
+    return;
+  }
+  uint8_t s = segments[c - '0'];
+  if (s & 0x01)
+    u8g2_DrawBox(u8g2, x + 1, top, 14, 3); // a
+  if (s & 0x02)
+    u8g2_DrawBox(u8g2, x + 12, top, 3, 15); // b
+  if (s & 0x04)
+    u8g2_DrawBox(u8g2, x + 12, top + 14, 3, 15); // c
+  if (s & 0x08)
+    u8g2_DrawBox(u8g2, x + 1, top + 26, 14, 3); // d
+  if (s & 0x10)
+    u8g2_DrawBox(u8g2, x + 1, top + 14, 3, 15); // e
+  if (s & 0x20)
+    u8g2_DrawBox(u8g2, x + 1, top, 3, 15); // f
+  if (s & 0x40)
+    u8g2_DrawBox(u8g2, x + 1, top + 13, 14, 3); // g
+}
+
+// The current readout of display(): right-aligned, one cell left for the
+// unit, bottom line 62.
+static void draw_readout(u8g2_t *u8g2, const char *s) {
+  u8g2_ClearBuffer(u8g2);
+  u8g2_uint_t x = 112 - 16 * strlen(s);
+  for (; *s != '\0'; s++, x += 16)
+    draw_digit(u8g2, x, 34, *s);
+}
+
+static bool ok = true;
+
+static void check(const char *what, const BusCount &c, unsigned long tiles,
+                  unsigned long expected_transactions,
+                  unsigned long expected_bytes, unsigned long expected_tiles) {
+  printf("  %-26s %4lu tiles %3lu transactions %5lu bytes\n", what, tiles,
+         c.transactions, c.bytes);
+  if (c.transactions != expected_transactions || c.bytes != expected_bytes ||
+      tiles != expected_tiles) {
+    printf("FAILED: %s: expected %lu tiles %lu transactions %lu bytes\n", what,
+           expected_tiles, expected_transactions, expected_bytes);
+    ok = false;
+  }
+}
+
+static void check_shadow(const char *what, u8g2_t *u8g2, const uint8_t *shadow) {
+  if (memcmp(u8g2_GetBufferPtr(u8g2), shadow, 1024) != 0) {
+    printf("FAILED: %s: shadow differs from the buffer\n", what);
+    ok = false;
+  }
+}
+
+// Sends the difference with u8g2_UpdateDisplayDiffStep() until it returns 0;
+// returns the tiles sent and sets *calls.
+static unsigned long step_all(u8g2_t *u8g2, uint8_t *shadow, uint16_t max_tiles,
+                              unsigned *calls) {
+  static uint8_t before[1024];
+  unsigned long tiles = 0;
+  *calls = 0;
+  uint8_t more;
+  do {
+    memcpy(before, shadow, sizeof(before));
+    more = u8g2_UpdateDisplayDiffStep(u8g2, shadow, max_tiles);
+    for (int i = 0; i < 1024; i += 8)
+      tiles += memcmp(before + i, shadow + i, 8) != 0;
+    (*calls)++;
+  } while (more);
+  return tiles;
+}
+
+int main() {
+  static u8g2_t u8g2;
+  static uint8_t shadow[1024];
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, byte_count, gpio_none);
+  u8g2_GetU8x8(&u8g2)->cad_cb = u8x8_cad_sh1106_fast_i2c;
+  u8x8_InitDisplay(u8g2_GetU8x8(&u8g2));
+  printf("SH1106 128x64, max_transfer %d\n", MAX_TRANSFER);
+
+  // full frame: every tile differs. A row of 16 tiles takes two
+  // transactions: 8 + 1 + 119 and 1 + 9 bytes.
+  memset(u8g2_GetBufferPtr(&u8g2), 0x55, 1024);
+  memset(shadow, 0, sizeof(shadow));
+  bus = BusCount();
+  unsigned long tiles = u8g2_UpdateDisplayDiff(&u8g2, shadow);
+  check("full frame", bus, tiles, 16, 8 * 138, 128);
+  check_shadow("full frame", &u8g2, shadow);
+
+  // the same in steps of 14 tiles (FRAME_STEP_TILES of the firmware): 10
+  // calls; a step ends after 14 tiles and a run at the end of its row, which
+  // makes 16 runs of at most 14 tiles, one transaction each
+  memset(shadow, 0, sizeof(shadow));
+  bus = BusCount();
+  unsigned calls;
+  tiles = step_all(&u8g2, shadow, 14, &calls);
+  check("full frame, steps of 14", bus, tiles, 16, 16 * 9 + 128 * 8, 128);
+  check_shadow("full frame, steps of 14", &u8g2, shadow);
+  if (calls != 10) {
+    printf("FAILED: %u steps instead of 10\n", calls);
+    ok = false;
+  }
+
+  // last digit 5 -> 8: segments b (tile column 13, rows 4..5; row 6 already
+  // has c) and e (column 12, rows 6..7): 4 runs of one tile
+  draw_readout(&u8g2, "12.345");
+  memcpy(shadow, u8g2_GetBufferPtr(&u8g2), sizeof(shadow));
+  draw_readout(&u8g2, "12.348");
+  bus = BusCount();
+  tiles = u8g2_UpdateDisplayDiff(&u8g2, shadow);
+  check("last digit 5 -> 8", bus, tiles, 4, 4 * 9 + 4 * 8, 4);
+  check_shadow("last digit 5 -> 8", &u8g2, shadow);
+
+  // last digit 8 -> 0 and back: segment g, lines 47..49, across columns 12
+  // and 13 of rows 5 and 6; the two tiles of a row are merged into one run
+  draw_readout(&u8g2, "12.340");
+  bus = BusCount();
+  tiles = step_all(&u8g2, shadow, 14, &calls);
+  check("last digit 8 -> 0, steps", bus, tiles, 2, 2 * 9 + 4 * 8, 4);
+  if (calls != 1) {
+    printf("FAILED: %u steps instead of 1\n", calls);
+    ok = false;
+  }
+  draw_readout(&u8g2, "12.348");
+  bus = BusCount();
+  tiles = u8g2_UpdateDisplayDiff(&u8g2, shadow);
+  check("last digit 0 -> 8", bus, tiles, 2, 2 * 9 + 4 * 8, 4);
+  check_shadow("last digit 0 -> 8", &u8g2, shadow);
+
+  // unchanged frame: nothing is sent
+  bus = BusCount();
+  tiles = u8g2_UpdateDisplayDiff(&u8g2, shadow);
+  check("unchanged", bus, tiles, 0, 0, 0);
+  bus = BusCount();
+  tiles = step_all(&u8g2, shadow, 14, &calls);
+  check("unchanged, steps of 14", bus, tiles, 0, 0, 0);
+  check_shadow("unchanged", &u8g2, shadow);
+
+  return ok ? 0 : 1;
+}
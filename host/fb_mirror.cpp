@@ -0,0 +1,61 @@
+#include "fb_mirror.h"
+
+#include <cstring>
+
+#include "meter_protocol.h"
+#include "u8x8.h"
+
+bool FrameMirror::apply(const char *line, size_t len) {
+  while (len > 0 &&
+         (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == 28))
+    len--;
+  if (len < 6 || line[0] != '#')
+    return false;
+
+  int row = hex_value(line[1]);
+  if (row < 0 || row >= tile_rows)
+    return false;
+  unsigned mask = 0;
+  for (int i = 2; i < 6; i++) {
+    int v = hex_value(line[i]);
+    if (v < 0)
+      return false;
+    mask = (mask << 4) | static_cast<unsigned>(v);
+  }
+
+  int tiles = __builtin_popcount(mask);
+  if (len != 6 + static_cast<size_t>(tiles) * 16)
+    return false;
+
+  uint8_t data[tile_cols * 8];
+  for (int i = 0; i < tiles * 8; i++) {
+    int hi = hex_value(line[6 + 2 * i]);
+    int lo = hex_value(line[7 + 2 * i]);
+    if (hi < 0 || lo < 0)
+      return false;
+    data[i] = static_cast<uint8_t>(hi << 4 | lo);
+  }
+
+  const uint8_t *src = data;
+  for (int col = 0; col < tile_cols; col++) {
+    if (!(mask & (1u << col)))
+      continue;
+    memcpy(buffer_ + (row * tile_cols + col) * 8, src, 8);
+    src += 8;
+  }
+  tiles_received_ += tiles;
+  return true;
+}
+
+bool FrameMirror::pixel(int x, int y) const {
+  if (x < 0 || x >= width || y < 0 || y >= height)
+    return false;
+  return u8x8_capture_get_pixel_1(x, y, const_cast<uint8_t *>(buffer_),
+                                  tile_cols) != 0;
+}
+
+void FrameMirror::write_pbm(void (*out)(const char *s)) {
+  u8x8_capture_write_pbm_pre(tile_cols, tile_rows, out);
+  u8x8_capture_write_pbm_buffer(buffer_, tile_cols, tile_rows,
+                                u8x8_capture_get_pixel_1, out);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Rebuilds the meter's display from the tile frames sent while the
+// "mirror" subscription is active (see src/main.cpp).
+//
+// The buffer uses the u8g2 vertical_top_lsb layout of the SH1106: 8 tile
+// rows of 16 tiles, each tile 8 bytes with one byte per pixel column.
+class FrameMirror {
+public:
+  static constexpr int tile_cols = 16;
+  static constexpr int tile_rows = 8;
+  static constexpr int width = tile_cols * 8;
+  static constexpr int height = tile_rows * 8;
+
+  // Applies one "#..." line. Returns false for any other or a corrupt line;
+  // a corrupt line leaves the buffer untouched.
+  bool apply(const char *line, size_t len);
+
+  bool pixel(int x, int y) const;
+  const uint8_t *buffer() const { return buffer_; }
+  uint32_t tiles_received() const { return tiles_received_; }
+
+  // Writes the current frame as plain PBM through u8x8_capture.
+  void write_pbm(void (*out)(const char *s));
+
+private:
+  uint8_t buffer_[tile_cols * tile_rows * 8] = {};
+  uint32_t tiles_received_ = 0;
+};
@@ -0,0 +1,266 @@
+// Compares the word and byte fill kernels of lib/u8g2 for vertical_top_lsb
+// buffers (u8g2_ll_hvline_vertical_top_lsb() and u8g2_draw_box_fast() with
+// u8g2_ll_box_vertical_top_lsb()) with the per-pixel path they replace, and
+// prints the time of both. Exits non-zero if a buffer differs.
+//
+// The reference is a second u8g2 with its own 1 KB buffer whose ll_hvline is
+// the old per-pixel procedure (U8G2_WITHOUT_HVLINE_SPEED_OPTIMIZATION).
+// u8g2_DrawBox() then takes the old way too: line by line through
+// u8g2_DrawHVLine(), clipped per line. Both start from the same random
+// content, so color 0, 1 and 2 (XOR) change set and cleared pixels.
+//
+// Checked are every horizontal and vertical line on the display, with all
+// colors; boxes with every y, height and width at the x positions of every
+// word alignment and at the right edge, and every x and width for y and
+// heights around the page boundaries; then random boxes and lines partly or
+// entirely off the display, with (non-empty) clip windows, and in a page
+// buffer.
+//
+//   fill_bench [<operations>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "clib/u8g2.h"
+}
+
+#ifndef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+#error "the fill kernels need U8G2_WITH_HVLINE_SPEED_OPTIMIZATION"
+#endif
+
+#define WIDTH 128
+#define HEIGHT 64
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+// the per-pixel u8g2_ll_hvline_vertical_top_lsb() of u8g2_ll_hvline.c
+static void pixel(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y) {
+  uint16_t offset = y & ~7;
+  offset *= u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  uint8_t *ptr = u8g2->tile_buf_ptr + offset + x;
+  uint8_t mask = 1 << (y & 7);
+  if (u8g2->draw_color <= 1)
+    *ptr |= mask;
+  if (u8g2->draw_color != 1)
+    *ptr ^= mask;
+}
+
+static void ll_hvline_pixels(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
+                             u8g2_uint_t len, uint8_t dir) {
+  do {
+    pixel(u8g2, x, y);
+    if (dir == 0)
+      x++;
+    else
+      y++;
+    len--;
+  } while (len != 0);
+}
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+struct Pair {
+  u8g2_t fast, ref;
+  size_t size; // buffer bytes
+  uint8_t content[WIDTH * HEIGHT / 8];
+  uint8_t ref_buf[WIDTH * HEIGHT / 8];
+};
+
+static void setup(Pair &p, bool page_buffer) {
+  if (page_buffer) {
+    u8g2_Setup_sh1106_i2c_128x64_noname_1(&p.fast, U8G2_R0, u8x8_byte_empty, gpio_none);
+    u8g2_Setup_sh1106_i2c_128x64_noname_1(&p.ref, U8G2_R0, u8x8_byte_empty, gpio_none);
+  } else {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&p.fast, U8G2_R0, u8x8_byte_empty, gpio_none);
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&p.ref, U8G2_R0, u8x8_byte_empty, gpio_none);
+  }
+  p.ref.tile_buf_ptr = p.ref_buf;
+  p.ref.ll_hvline = ll_hvline_pixels;
+  p.size = u8g2_GetBufferTileWidth(&p.fast) * 8 * u8g2_GetBufferTileHeight(&p.fast);
+  for (size_t i = 0; i < p.size; i++)
+    p.content[i] = static_cast<uint8_t>(random_next());
+}
+
+static void set_row(Pair &p, uint8_t row) {
+  u8g2_SetBufferCurrTileRow(&p.fast, row);
+  u8g2_SetBufferCurrTileRow(&p.ref, row);
+}
+
+static void set_color(Pair &p, uint8_t color) {
+  u8g2_SetDrawColor(&p.fast, color);
+  u8g2_SetDrawColor(&p.ref, color);
+}
+
+static bool ok = true;
+static unsigned long checks = 0;
+
+// Runs op on both from the same content and compares the buffers.
+template <typename Op> static void compare(Pair &p, const char *what, Op op) {
+  memcpy(p.fast.tile_buf_ptr, p.content, p.size);
+  memcpy(p.ref.tile_buf_ptr, p.content, p.size);
+  op(&p.fast);
+  op(&p.ref);
+  checks++;
+  if (memcmp(p.fast.tile_buf_ptr, p.ref.tile_buf_ptr, p.size) != 0 && ok) {
+    printf("FAILED: %s\n", what);
+    ok = false;
+  }
+}
+
+static void check_lines(Pair &p) {
+  char what[80];
+  for (uint8_t color = 0; color <= 2; color++) {
+    set_color(p, color);
+    for (u8g2_uint_t y = 0; y < HEIGHT; y++) {
+      for (u8g2_uint_t x = 0; x < WIDTH; x++) {
+        for (u8g2_uint_t len = 1; x + len <= WIDTH; len++) {
+          snprintf(what, sizeof(what), "hline %u,%u len %u color %u", x, y, len, color);
+          compare(p, what, [&](u8g2_t *u) { u8g2_DrawHLine(u, x, y, len); });
+        }
+        for (u8g2_uint_t len = 1; y + len <= HEIGHT; len++) {
+          snprintf(what, sizeof(what), "vline %u,%u len %u color %u", x, y, len, color);
+          compare(p, what, [&](u8g2_t *u) { u8g2_DrawVLine(u, x, y, len); });
+        }
+      }
+    }
+  }
+}
+
+static void check_box(Pair &p, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w,
+                      u8g2_uint_t h, uint8_t color) {
+  char what[80];
+  snprintf(what, sizeof(what), "box %u,%u %ux%u color %u", x, y, w, h, color);
+  compare(p, what, [&](u8g2_t *u) { u8g2_DrawBox(u, x, y, w, h); });
+}
+
+static void check_boxes(Pair &p) {
+  // every word alignment at the left edge and every tail at the right one
+  static const u8g2_uint_t xs[] = {0, 1, 2, 3, 120, 121, 122, 123, 124, 125, 126, 127};
+  static const u8g2_uint_t ys[] = {0, 1, 6, 7, 8, 9, 15, 16, 31, 33, 56, 63};
+  static const u8g2_uint_t hs[] = {1, 2, 7, 8, 9, 16, 17, 33, 64};
+  for (uint8_t color = 0; color <= 2; color++) {
+    set_color(p, color);
+    for (u8g2_uint_t x : xs)
+      for (u8g2_uint_t w = 1; x + w <= WIDTH; w++)
+        for (u8g2_uint_t y = 0; y < HEIGHT; y++)
+          for (u8g2_uint_t h = 1; y + h <= HEIGHT; h++)
+            check_box(p, x, y, w, h, color);
+    for (u8g2_uint_t y : ys)
+      for (u8g2_uint_t h : hs)
+        for (u8g2_uint_t x = 0; x < WIDTH && y + h <= HEIGHT; x++)
+          for (u8g2_uint_t w = 1; x + w <= WIDTH; w++)
+            check_box(p, x, y, w, h, color);
+  }
+}
+
+// A coordinate near or off the display, sometimes "negative".
+static u8g2_uint_t random_coord(u8g2_uint_t size) {
+  switch (random_next() % 4) {
+  case 0:
+    return static_cast<u8g2_uint_t>(-static_cast<int>(random_next() % 16));
+  case 1:
+    return size - 8 + random_next() % 16;
+  default:
+    return random_next() % size;
+  }
+}
+
+static void check_random(Pair &p, unsigned count, bool page_buffer) {
+  char what[96];
+  for (unsigned i = 0; i < count; i++) {
+    u8g2_uint_t x = random_coord(WIDTH), y = random_coord(HEIGHT);
+    u8g2_uint_t w = 1 + random_next() % (random_next() % 2 ? 32 : 300);
+    u8g2_uint_t h = 1 + random_next() % (random_next() % 2 ? 16 : 100);
+    uint8_t color = random_next() % 3;
+    set_color(p, color);
+    if (random_next() % 2) {
+      // not empty: u8g2_clip_intersection2() assumes c < d, else it passes
+      // lines of length 0 on, which the per-pixel path draws as 65536 pixels
+      u8g2_uint_t cx0 = random_next() % WIDTH, cy0 = random_next() % HEIGHT;
+      u8g2_uint_t cx1 = cx0 + 1 + random_next() % (WIDTH - cx0);
+      u8g2_uint_t cy1 = cy0 + 1 + random_next() % (HEIGHT - cy0);
+      u8g2_SetClipWindow(&p.fast, cx0, cy0, cx1, cy1);
+      u8g2_SetClipWindow(&p.ref, cx0, cy0, cx1, cy1);
+    } else {
+      u8g2_SetMaxClipWindow(&p.fast);
+      u8g2_SetMaxClipWindow(&p.ref);
+    }
+    uint8_t rows = page_buffer ? HEIGHT / 8 : 1;
+    for (uint8_t row = 0; row < rows; row++) {
+      if (page_buffer)
+        set_row(p, row);
+      snprintf(what, sizeof(what), "%s box %u,%u %ux%u color %u row %u",
+               page_buffer ? "page" : "clipped", x, y, w, h, color, row);
+      compare(p, what, [&](u8g2_t *u) { u8g2_DrawBox(u, x, y, w, h); });
+      snprintf(what, sizeof(what), "%s lines %u,%u %u %u color %u row %u",
+               page_buffer ? "page" : "clipped", x, y, w, h, color, row);
+      compare(p, what, [&](u8g2_t *u) {
+        u8g2_DrawHLine(u, x, y, w);
+        u8g2_DrawVLine(u, x, y, h);
+      });
+    }
+  }
+  u8g2_SetMaxClipWindow(&p.fast);
+  u8g2_SetMaxClipWindow(&p.ref);
+}
+
+struct Shape {
+  u8g2_uint_t x, y, w, h;
+  uint8_t color;
+};
+
+template <typename Op>
+static double time_ns(u8g2_t *u, const Shape *shapes, unsigned count, Op op) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < count; i++) {
+    const Shape &s = shapes[i % 1024];
+    u8g2_SetDrawColor(u, s.color);
+    op(u, s);
+  }
+  std::chrono::duration<double, std::nano> t = std::chrono::steady_clock::now() - start;
+  return t.count() / count;
+}
+
+int main(int argc, char **argv) {
+  unsigned count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+  static Pair full, page;
+  setup(full, false);
+  setup(page, true);
+
+  check_lines(full);
+  check_boxes(full);
+  check_random(full, 200000, false);
+  check_random(page, 20000, true);
+  printf("%lu buffers compared\n", checks);
+
+  // shapes on the display, like those of the meter screens
+  static Shape shapes[1024];
+  for (Shape &s : shapes) {
+    s.x = random_next() % WIDTH;
+    s.y = random_next() % HEIGHT;
+    s.w = 1 + random_next() % (WIDTH - s.x);
+    s.h = 1 + random_next() % (HEIGHT - s.y);
+    s.color = random_next() % 3;
+  }
+  auto hline = [](u8g2_t *u, const Shape &s) { u8g2_DrawHLine(u, s.x, s.y, s.w); };
+  auto vline = [](u8g2_t *u, const Shape &s) { u8g2_DrawVLine(u, s.x, s.y, s.h); };
+  auto box = [](u8g2_t *u, const Shape &s) { u8g2_DrawBox(u, s.x, s.y, s.w, s.h); };
+  printf("                  per pixel    kernel\n");
+  printf("  hline        %9.1f ns %7.1f ns\n", time_ns(&full.ref, shapes, count, hline),
+         time_ns(&full.fast, shapes, count, hline));
+  printf("  vline        %9.1f ns %7.1f ns\n", time_ns(&full.ref, shapes, count, vline),
+         time_ns(&full.fast, shapes, count, vline));
+  printf("  box          %9.1f ns %7.1f ns\n", time_ns(&full.ref, shapes, count / 10, box),
+         time_ns(&full.fast, shapes, count / 10, box));
+  return ok ? 0 : 1;
+}
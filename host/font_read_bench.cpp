@@ -0,0 +1,240 @@
+// Checks the word-wise font reads of lib/u8g2 (U8X8_WITH_FONT_WORD_READ) on
+// the host. Build the library and this tool with
+// -DU8X8_FONT_WORD_READ_EMULATION: like on the ESP8266, font data is then
+// only read with aligned 32 bit loads, which abort if misaligned and are
+// counted. Add -DU8X8_NO_FONT_WORD_READ for the byte reads of
+// u8x8_pgm_read_esp() to compare with.
+//
+// Compares the bit fields of the glyph decoder, the glyph search, the font
+// header and u8x8 tiles with plain reads of the font data, and exits non-zero
+// if one differs. Prints the loads per operation and a hash of every glyph of
+// the fonts drawn, which is the same for both builds.
+//
+//   font_read_bench [<seed>]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "U8g2lib.h"
+
+#ifndef U8X8_FONT_WORD_READ_EMULATION
+#error "build with -DU8X8_FONT_WORD_READ_EMULATION"
+#endif
+
+static const uint8_t *const fonts[] = {
+    u8g2_font_profont10_tr, u8g2_font_profont12_tr, u8g2_font_profont17_tr,
+    u8g2_font_profont29_tr};
+static const uint8_t *const tile_fonts[] = {u8x8_font_8x13B_1x2_r,
+                                            u8x8_font_chroma48medium8_r,
+                                            u8x8_font_profont29_2x3_r};
+
+#define FONT_HEADER_SIZE 23 // U8G2_FONT_DATA_STRUCT_SIZE of u8g2_font.c
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+class BenchDisplay : public U8G2 {
+public:
+  BenchDisplay() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_empty,
+                                          gpio_none);
+  }
+};
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static bool ok = true;
+
+static void fail(const char *what, int font, unsigned where) {
+  if (ok)
+    printf("FAILED: %s of font %d at %u\n", what, font, where);
+  ok = false;
+}
+
+// cnt bits at bit pos of p, the reference for the glyph decoder
+static uint8_t plain_bits(const uint8_t *p, uint8_t pos, uint8_t cnt) {
+  uint16_t bits = p[0] | (p[1] << 8);
+  return (bits >> pos) & ((1U << cnt) - 1);
+}
+
+// Random runs of bit fields from every byte and bit position of the glyph
+// data.
+static void check_bits(int n, const uint8_t *font) {
+  size_t size = u8g2_GetFontSize(font);
+  for (size_t start = FONT_HEADER_SIZE; start + 8 < size; start++) {
+    for (uint8_t pos = 0; pos < 8; pos++) {
+      u8g2_font_decode_t f;
+      f.decode_ptr = font + start;
+      f.decode_bit_pos = pos;
+#ifdef U8X8_WITH_FONT_WORD_READ
+      u8x8_font_word_init(&f.decode_word);
+#endif
+      const uint8_t *p = font + start;
+      uint8_t bit = pos;
+      for (int i = 0; i < 4; i++) {
+        uint8_t cnt = 1 + random_next() % 8;
+        if (f.decode_ptr != p ||
+            u8g2_font_decode_get_unsigned_bits(&f, cnt) !=
+                plain_bits(p, bit, cnt) ||
+            f.decode_bit_pos != (bit + cnt) % 8) {
+          fail("bit field", n, start);
+          return;
+        }
+        p += (bit + cnt) / 8;
+        bit = (bit + cnt) % 8;
+      }
+    }
+  }
+}
+
+// u8g2_font_get_glyph_data() of every encoding against a walk of the glyph
+// list.
+static void check_search(int n, BenchDisplay &d, const uint8_t *font) {
+  for (unsigned encoding = 0; encoding < 256; encoding++) {
+    const uint8_t *expected = nullptr;
+    for (const uint8_t *g = font + FONT_HEADER_SIZE; g[1] != 0;
+         g += g[1]) {
+      if (g[0] == encoding) {
+        expected = g + 2;
+        break;
+      }
+    }
+    if (u8g2_font_get_glyph_data(d.getU8g2(), encoding) != expected)
+      fail("glyph search", n, encoding);
+  }
+}
+
+static void check_header(int n, BenchDisplay &d, const uint8_t *font) {
+  const u8g2_font_info_t &info = d.getU8g2()->font_info;
+  uint8_t fields[] = {info.glyph_cnt,
+                      info.bbx_mode,
+                      info.bits_per_0,
+                      info.bits_per_1,
+                      info.bits_per_char_width,
+                      info.bits_per_char_height,
+                      info.bits_per_char_x,
+                      info.bits_per_char_y,
+                      info.bits_per_delta_x,
+                      static_cast<uint8_t>(info.max_char_width),
+                      static_cast<uint8_t>(info.max_char_height),
+                      static_cast<uint8_t>(info.x_offset),
+                      static_cast<uint8_t>(info.y_offset),
+                      static_cast<uint8_t>(info.ascent_A),
+                      static_cast<uint8_t>(info.descent_g),
+                      static_cast<uint8_t>(info.ascent_para),
+                      static_cast<uint8_t>(info.descent_para)};
+  if (memcmp(fields, font, sizeof(fields)) != 0 ||
+      info.start_pos_upper_A != (font[17] << 8 | font[18]) ||
+      info.start_pos_lower_a != (font[19] << 8 | font[20]))
+    fail("header", n, 0);
+}
+
+static void check_tiles(int n, BenchDisplay &d, const uint8_t *font) {
+  u8x8_t *u8x8 = d.getU8x8();
+  u8x8_SetFont(u8x8, font);
+  unsigned tiles = font[2] * font[3];
+  for (unsigned encoding = font[0]; encoding <= font[1]; encoding++) {
+    for (unsigned t = 0; t < tiles; t++) {
+      uint8_t buf[8];
+      u8x8_get_glyph_data(u8x8, encoding, buf, t);
+      if (memcmp(buf, font + 4 + ((encoding - font[0]) * tiles + t) * 8, 8))
+        fail("tile", n, encoding);
+    }
+  }
+}
+
+static uint32_t fnv(uint32_t hash, const uint8_t *p, size_t n) {
+  while (n--)
+    hash = (hash ^ *p++) * 16777619u;
+  return hash;
+}
+
+int main(int argc, char **argv) {
+  random_state = argc > 1 ? strtoul(argv[1], nullptr, 0) | 1 : 1;
+  static BenchDisplay d;
+  u8x8_InitDisplay(d.getU8x8()); // the byte procedure ignores everything
+
+  for (int n = 0; n < 4; n++) {
+    d.setFont(fonts[n]);
+    check_bits(n, fonts[n]);
+    check_search(n, d, fonts[n]);
+    check_header(n, d, fonts[n]);
+  }
+  for (int n = 0; n < 3; n++)
+    check_tiles(n, d, tile_fonts[n]);
+
+  // every glyph, decoded without the glyph cache
+  uint32_t hash = 2166136261u;
+  unsigned long glyphs = 0, glyph_loads = 0, font_loads = 0, font_changes = 0;
+  for (int n = 0; n < 4; n++) {
+    unsigned long loads = u8x8_font_word_loads;
+    d.setFont(fonts[n]);
+    font_loads += u8x8_font_word_loads - loads;
+    font_changes++;
+    for (unsigned encoding = 32; encoding < 256; encoding++) {
+      if (u8g2_font_get_glyph_data(d.getU8g2(), encoding) == nullptr)
+        continue;
+      d.clearBuffer();
+#ifdef U8G2_WITH_GLYPH_CACHE
+      u8g2_ClearGlyphCache();
+#endif
+      loads = u8x8_font_word_loads;
+      d.drawGlyph(10, 40, encoding);
+      glyph_loads += u8x8_font_word_loads - loads;
+      glyphs++;
+      hash = fnv(hash, d.getBufferPtr(), 1024);
+    }
+  }
+
+  // the glyph search without the index, as for fonts beyond
+  // U8G2_GLYPH_INDEX_FONTS
+  unsigned long searches = 0, search_loads = 0;
+  for (int n = 0; n < 4; n++) {
+    d.setFont(fonts[n]);
+#ifdef U8G2_WITH_GLYPH_INDEX
+    d.getU8g2()->glyph_index = nullptr;
+#endif
+    for (unsigned encoding = 32; encoding < 128; encoding++) {
+      unsigned long loads = u8x8_font_word_loads;
+      u8g2_font_get_glyph_data(d.getU8g2(), encoding);
+      search_loads += u8x8_font_word_loads - loads;
+      searches++;
+    }
+  }
+
+  unsigned long tiles = 0, tile_loads = 0;
+  for (int n = 0; n < 3; n++) {
+    u8x8_SetFont(d.getU8x8(), tile_fonts[n]);
+    uint8_t th = tile_fonts[n][2], tv = tile_fonts[n][3];
+    for (unsigned encoding = 32; encoding < 127; encoding++) {
+      unsigned long loads = u8x8_font_word_loads;
+      u8x8_DrawGlyph(d.getU8x8(), 0, 0, encoding);
+      tile_loads += u8x8_font_word_loads - loads;
+      tiles += th * tv;
+    }
+  }
+
+#ifdef U8X8_WITH_FONT_WORD_READ
+  printf("word reads\n");
+#else
+  printf("byte reads\n");
+#endif
+  printf("  %-24s %8.1f loads\n", "setFont header",
+         static_cast<double>(font_loads) / font_changes);
+  printf("  %-24s %8.1f loads\n", "glyph decode",
+         static_cast<double>(glyph_loads) / glyphs);
+  printf("  %-24s %8.1f loads\n", "glyph search",
+         static_cast<double>(search_loads) / searches);
+  printf("  %-24s %8.1f loads\n", "u8x8 tile",
+         static_cast<double>(tile_loads) / tiles);
+  printf("%lu glyphs drawn, hash %08lx\n", glyphs,
+         static_cast<unsigned long>(hash));
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Generates src/font_subsets.c from font_subsets[] of src/font_subsets.h:
+// each u8g2 font reduced to its character set. The subset keeps the font
+// header and the data of the remaining glyphs, so text renders the same. The
+// tool checks this by drawing every character, and the whole set, with the
+// full and the subset font, and exits non-zero if a buffer, string width or
+// ascent/descent differs, or if a character is missing from the full font.
+//
+//   font_subset <output.c>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "font_subsets.h"
+
+// offsets in the font header, see u8g2_font.c
+#define HDR_SIZE 23 // U8G2_FONT_DATA_STRUCT_SIZE
+#define HDR_GLYPH_CNT 0
+#define HDR_POS_UPPER_A 17
+#define HDR_POS_LOWER_A 19
+#define HDR_POS_UNICODE 21
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+static void put_word(std::vector<uint8_t> &v, size_t pos, size_t value) {
+  v[pos] = static_cast<uint8_t>(value >> 8);
+  v[pos + 1] = static_cast<uint8_t>(value);
+}
+
+// Glyphs searched by u8g2_font_get_glyph_data() without the glyph index
+// until it finds encoding: the list starts at the 'A' or 'a' position.
+static unsigned lookup_steps(const uint8_t *font, uint8_t encoding) {
+  const uint8_t *g = font + HDR_SIZE;
+  if (encoding >= 'a')
+    g += (font[HDR_POS_LOWER_A] << 8) | font[HDR_POS_LOWER_A + 1];
+  else if (encoding >= 'A')
+    g += (font[HDR_POS_UPPER_A] << 8) | font[HDR_POS_UPPER_A + 1];
+  unsigned steps = 1;
+  for (; g[1] != 0 && g[0] != encoding; g += g[1])
+    steps++;
+  return steps;
+}
+
+// Returns the subset font, empty if a character is not in the font.
+static std::vector<uint8_t> make_subset(const font_subset &fs) {
+  std::vector<uint8_t> out(fs.font, fs.font + HDR_SIZE);
+  size_t upper = 0, lower = 0, count = 0;
+  bool have_upper = false, have_lower = false;
+  std::string missing = fs.chars;
+
+  // the glyphs of the font are in ascending order, keep that order
+  for (const uint8_t *g = fs.font + HDR_SIZE; g[1] != 0; g += g[1]) {
+    if (g[0] == 0 || strchr(fs.chars, g[0]) == nullptr)
+      continue;
+    size_t pos = out.size() - HDR_SIZE;
+    if (!have_upper && g[0] >= 'A') {
+      upper = pos;
+      have_upper = true;
+    }
+    if (!have_lower && g[0] >= 'a') {
+      lower = pos;
+      have_lower = true;
+    }
+    out.insert(out.end(), g, g + g[1]);
+    missing.erase(missing.find(static_cast<char>(g[0])), 1);
+    count++;
+  }
+  if (!missing.empty()) {
+    fprintf(stderr, "%s: \"%s\" not in the font\n", fs.name, missing.c_str());
+    return {};
+  }
+
+  // end of the glyph list, then a unicode table without glyphs
+  size_t end = out.size() - HDR_SIZE;
+  out.insert(out.end(), {0, 0});
+  size_t unicode = out.size() - HDR_SIZE;
+  out.insert(out.end(), {0, 4, 0xff, 0xff, 0, 0});
+
+  out[HDR_GLYPH_CNT] = static_cast<uint8_t>(count);
+  put_word(out, HDR_POS_UPPER_A, have_upper ? upper : end);
+  put_word(out, HDR_POS_LOWER_A, have_lower ? lower : end);
+  put_word(out, HDR_POS_UNICODE, unicode);
+  return out;
+}
+
+// The setup procedure shares one static buffer, so that each display gets
+// its own.
+struct Display {
+  u8g2_t u8g2;
+  uint8_t buf[1024];
+
+  Display() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_empty,
+                                          gpio_none);
+    u8g2.tile_buf_ptr = buf;
+  }
+
+  u8g2_uint_t draw(const uint8_t *font, const char *s) {
+    u8g2_ClearBuffer(&u8g2);
+    u8g2_SetFont(&u8g2, font);
+    u8g2_DrawStr(&u8g2, 2, 40, s);
+    return u8g2_GetStrWidth(&u8g2, s);
+  }
+};
+
+static bool same_rendering(const font_subset &fs, const uint8_t *subset) {
+  static Display full, sub;
+  std::vector<std::string> texts{fs.chars};
+  for (const char *c = fs.chars; *c != '\0'; c++)
+    texts.push_back(std::string(1, *c));
+  for (const std::string &t : texts) {
+    u8g2_uint_t w_full = full.draw(fs.font, t.c_str());
+    u8g2_uint_t w_sub = sub.draw(subset, t.c_str());
+    if (w_full != w_sub || memcmp(full.buf, sub.buf, sizeof(full.buf)) != 0 ||
+        u8g2_GetAscent(&full.u8g2) != u8g2_GetAscent(&sub.u8g2) ||
+        u8g2_GetDescent(&full.u8g2) != u8g2_GetDescent(&sub.u8g2)) {
+      fprintf(stderr, "%s: \"%s\" differs\n", fs.name, t.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+static void write_font(FILE *f, const char *name,
+                       const std::vector<uint8_t> &data) {
+  fprintf(f, "const uint8_t %s[%zu] U8G2_FONT_SECTION(\"%s\") = {", name,
+          data.size(), name);
+  for (size_t i = 0; i < data.size(); i++)
+    fprintf(f, "%s%u%s", i % 16 == 0 ? "\n  " : "", data[i],
+            i + 1 < data.size() ? "," : "");
+  fprintf(f, "\n};\n\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: font_subset <output.c>\n");
+    return 2;
+  }
+  std::vector<std::vector<uint8_t>> subsets;
+  bool ok = true;
+  printf("%-28s %6s %6s %14s\n", "", "bytes", "glyphs", "lookup steps");
+  for (const font_subset &fs : font_subsets) {
+    std::vector<uint8_t> s = make_subset(fs);
+    if (s.empty() || !same_rendering(fs, s.data())) {
+      ok = false;
+      continue;
+    }
+    unsigned steps_full = 0, steps_sub = 0, n = 0;
+    for (const char *c = fs.chars; *c != '\0'; c++, n++) {
+      steps_full += lookup_steps(fs.font, *c);
+      steps_sub += lookup_steps(s.data(), *c);
+    }
+    printf("%-28s %6zu %6u %14.1f  full font\n", fs.name,
+           static_cast<size_t>(u8g2_GetFontSize(fs.font)), fs.font[0],
+           static_cast<double>(steps_full) / n);
+    printf("%-28s %6zu %6u %14.1f  subset\n", "", s.size(), s[0],
+           static_cast<double>(steps_sub) / n);
+    subsets.push_back(s);
+  }
+  if (!ok)
+    return 1;
+
+  FILE *f = fopen(argv[1], "w");
+  if (f == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  fprintf(f, "/*\n  font_subsets.c\n\n  Generated by host/font_subset from "
+             "font_subsets[] in font_subsets.h, do not edit.\n*/\n\n");
+  fprintf(f, "#include <clib/u8g2.h>\n\n#ifdef FONT_SUBSETS\n\n");
+  for (size_t i = 0; i < subsets.size(); i++) {
+    std::string chars = font_subsets[i].chars;
+    fprintf(f, "/* \"%s\" */\n", chars.c_str());
+    write_font(f, font_subsets[i].name, subsets[i]);
+  }
+  fprintf(f, "#endif /* FONT_SUBSETS */\n");
+  return fclose(f) == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+# PlatformIO pre-build script (extra_scripts in platformio.ini): with
+# -DFONT_SUBSETS in build_flags, builds host/font_subset with the host
+# compiler and runs it to write src/font_subsets.c before the firmware is
+# compiled. It only runs if the file is missing or older than the character
+# sets, the tool or the font data. Without -DFONT_SUBSETS it does nothing.
+#
+# The u8g2 library is compiled for the host with the -D flags of build_flags,
+# which must match those of the firmware (the glyph index changes u8g2_t).
+# HOST_CC and HOST_CXX select other compilers than gcc and g++.
+
+import glob
+import os
+import subprocess
+
+Import("env")
+
+project_dir = env.subst("$PROJECT_DIR")
+output = os.path.join(project_dir, "src", "font_subsets.c")
+clib = os.path.join(project_dir, "lib", "u8g2", "clib")
+
+
+def define_flags():
+    flags = []
+    for option in env.GetProjectOption("build_flags", []):
+        flags += [f for f in option.split() if f.startswith("-D")]
+    return flags
+
+
+def stale(inputs):
+    if not os.path.exists(output):
+        return True
+    built = os.path.getmtime(output)
+    return any(os.path.getmtime(f) > built for f in inputs if os.path.exists(f))
+
+
+def run(cmd, cwd=None):
+    print(" ".join(cmd))
+    if subprocess.call(cmd, cwd=cwd) != 0:
+        print("font_subset.py: command failed, src/font_subsets.c not written")
+        env.Exit(1)
+
+
+def generate(defines):
+    work = os.path.join(env.subst("$BUILD_DIR"), "font_subset")
+    if not os.path.isdir(work):
+        os.makedirs(work)
+    cc = os.environ.get("HOST_CC", "gcc")
+    cxx = os.environ.get("HOST_CXX", "g++")
+    run([cc, "-O2", "-c"] + defines + ["-I" + clib] +
+        sorted(glob.glob(os.path.join(clib, "*.c"))), cwd=work)
+    tool = os.path.join(work, "font_subset")
+    run([cxx, "-std=c++17", "-O2"] + defines +
+        ["-I" + os.path.join(project_dir, "lib", "u8g2"),
+         "-I" + os.path.join(project_dir, "src"),
+         os.path.join(project_dir, "host", "font_subset.cpp")] +
+        sorted(glob.glob(os.path.join(work, "*.o"))) + ["-o", tool])
+    run([tool, output])
+
+
+defines = define_flags()
+if "-DFONT_SUBSETS" in defines:
+    inputs = [os.path.join(project_dir, "src", "font_subsets.h"),
+              os.path.join(project_dir, "host", "font_subset.cpp"),
+              os.path.join(clib, "u8g2_fonts.c")]
+    if stale(inputs):
+        generate(defines)
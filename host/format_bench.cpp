@@ -0,0 +1,173 @@
+// Checks format_milli() and format_milli_auto() of src/fixed_format.cpp
+// against snprintf("%.*f", decimals, milli / 1000.0) and prints the time per
+// call of both. Exits non-zero if an output differs.
+//
+// Every value the firmware formats, +-400000 milli-units (8.192 A, 40.96 V
+// and their product in mW), is checked with 0..3 decimals; then rounding
+// carries up to the int32 limits, field widths and too small buffers.
+//
+// format_milli() rounds the exact value half away from zero. milli / 1000.0
+// is not exact, so where the dropped digits are exactly half, printf rounds
+// the double either way; there the reference is the value one milli-unit
+// further from zero, which rounds like the exact one.
+//
+//   format_bench [<calls>]
+
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include "fixed_format.h"
+
+#define FIRMWARE_RANGE 400000
+
+static const int32_t divisors[] = {1000, 100, 10, 1};
+
+static bool ok = true;
+static unsigned long checks = 0, ties = 0;
+
+// printf of milli / 1000 with the rounding of format_milli()
+static void reference(char *buf, size_t size, int32_t milli, uint8_t decimals,
+                      const char *unit, int width) {
+  char num[32];
+  int32_t div = divisors[decimals];
+  double value = milli / 1000.0;
+  if (div > 1 && milli % div != 0 &&
+      (milli % div == div / 2 || milli % div == -div / 2)) {
+    char plain[32];
+    snprintf(plain, sizeof(plain), "%.*f", decimals, value);
+    value = (milli + (milli < 0 ? -1.0 : 1.0)) / 1000.0;
+    snprintf(num, sizeof(num), "%.*f", decimals, value);
+    ties += strcmp(plain, num) != 0;
+  } else {
+    snprintf(num, sizeof(num), "%.*f", decimals, value);
+  }
+  char field[40];
+  snprintf(field, sizeof(field), "%s%s", num, unit);
+  snprintf(buf, size, "%*s", width, field);
+}
+
+static void check(int32_t milli, uint8_t decimals, const char *unit, int width) {
+  char buf[40], expected[40];
+  size_t len = format_milli(buf, sizeof(buf), milli, decimals, unit, width);
+  reference(expected, sizeof(expected), milli, decimals, unit, width);
+  checks++;
+  if (len != strlen(expected) || strcmp(buf, expected) != 0) {
+    if (ok)
+      printf("FAILED: format_milli(%" PRId32 ", %u, \"%s\", %d) \"%s\", "
+             "expected \"%s\"\n",
+             milli, decimals, unit, width, buf, expected);
+    ok = false;
+  }
+}
+
+static void check_auto(int32_t milli, uint8_t decimals, char unit, int width) {
+  char buf[40], expected[40];
+  size_t len = format_milli_auto(buf, sizeof(buf), milli, decimals, unit, width);
+  if (milli > -1000 && milli < 1000) {
+    char name[3] = {'m', unit, '\0'};
+    char field[40];
+    snprintf(field, sizeof(field), "%.0f%s", static_cast<double>(milli), name);
+    snprintf(expected, sizeof(expected), "%*s", width, field);
+  } else {
+    char name[2] = {unit, '\0'};
+    reference(expected, sizeof(expected), milli, decimals, name, width);
+  }
+  checks++;
+  if (len != strlen(expected) || strcmp(buf, expected) != 0) {
+    if (ok)
+      printf("FAILED: format_milli_auto(%" PRId32 ", %u, '%c', %d) \"%s\", "
+             "expected \"%s\"\n",
+             milli, decimals, unit, width, buf, expected);
+    ok = false;
+  }
+}
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+int main(int argc, char **argv) {
+  unsigned calls = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+
+  for (int32_t milli = -FIRMWARE_RANGE; milli <= FIRMWARE_RANGE; milli++) {
+    for (uint8_t decimals = 0; decimals <= 3; decimals++)
+      check(milli, decimals, "A", 0);
+    check_auto(milli, 2, 'W', 0);
+  }
+
+  // carries into a new digit, around every power of ten up to the limits
+  for (int64_t p = 1; p <= INT32_MAX; p *= 10) {
+    for (int64_t d = -600; d <= 600; d++) {
+      for (int sign = -1; sign <= 1; sign += 2) {
+        int64_t v = sign * (p + d);
+        if (v < INT32_MIN || v > INT32_MAX)
+          continue;
+        for (uint8_t decimals = 0; decimals <= 3; decimals++)
+          check(static_cast<int32_t>(v), decimals, "V", 0);
+        check_auto(static_cast<int32_t>(v), 1, 'A', 0);
+      }
+    }
+  }
+  for (int32_t milli : {INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 1})
+    for (uint8_t decimals = 0; decimals <= 3; decimals++)
+      check(milli, decimals, "", 0);
+
+  // field widths, units, and buffers one byte short and just large enough
+  for (unsigned i = 0; i < 200000; i++) {
+    int32_t milli = static_cast<int32_t>(random_next());
+    if (i % 2)
+      milli %= FIRMWARE_RANGE;
+    uint8_t decimals = random_next() % 4;
+    int width = random_next() % 16;
+    const char *units[] = {"", "A", "V ", "mW"};
+    check(milli, decimals, units[random_next() % 4], width);
+    check_auto(milli % 5000, decimals, 'A', width);
+
+    char buf[40];
+    size_t len = format_milli(buf, sizeof(buf), milli, decimals, "A", width);
+    if (format_milli(buf, len, milli, decimals, "A", width) != 0 ||
+        format_milli(buf, len + 1, milli, decimals, "A", width) != len) {
+      if (ok)
+        printf("FAILED: buffer size %zu for %" PRId32 "\n", len, milli);
+      ok = false;
+    }
+  }
+
+  // the firmware's fields, formatted beforehand
+  static int32_t values[1024];
+  for (int32_t &v : values)
+    v = static_cast<int32_t>(random_next() % (2 * FIRMWARE_RANGE)) - FIRMWARE_RANGE;
+  volatile size_t sum = 0;
+  char buf[32];
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < calls; i++)
+    sum += snprintf(buf, sizeof(buf), "%.*f%s", i % 4, values[i % 1024] / 1000.0, "A");
+  auto mid = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < calls; i++)
+    sum += format_milli(buf, sizeof(buf), values[i % 1024], i % 4, "A");
+  auto mid2 = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < calls; i++)
+    sum += format_milli_auto(buf, sizeof(buf), values[i % 1024], i % 4, 'A');
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::nano> printf_ns = mid - start,
+                                           milli_ns = mid2 - mid,
+                                           auto_ns = end - mid2;
+
+  printf("%lu outputs checked, %lu ties where printf of the double rounds "
+         "the other way\n",
+         checks, ties);
+  printf("  snprintf           %7.1f ns/call\n", printf_ns.count() / calls);
+  printf("  format_milli       %7.1f ns/call\n", milli_ns.count() / calls);
+  printf("  format_milli_auto  %7.1f ns/call\n", auto_ns.count() / calls);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Measures the glyph index of lib/u8g2 (U8G2_WITH_GLYPH_INDEX) with the
+// current readout of the meter screen in profont29: the glyph lookup, the
+// width and the drawing of a reading, each with the index and with the walk
+// of the glyph list it replaces, and u8g2_SetFont() when the index is reused
+// and when it has to be built. Exits non-zero if a lookup or a drawn buffer
+// differs between both.
+//
+// Build the library and this tool with -DU8G2_WITH_GLYPH_INDEX; without
+// U8G2_WITH_GLYPH_CACHE drawStr() looks up every glyph it draws.
+//
+//   glyph_index_bench [<strings>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "U8g2lib.h"
+#include "fixed_format.h"
+
+#ifndef U8G2_WITH_GLYPH_INDEX
+#error "build with -DU8G2_WITH_GLYPH_INDEX"
+#endif
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+class BenchDisplay : public U8G2 {
+public:
+  BenchDisplay() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_empty,
+                                          gpio_none);
+  }
+};
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+typedef std::chrono::duration<double, std::nano> nanoseconds;
+
+int main(int argc, char **argv) {
+  unsigned strings = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+  static BenchDisplay d;
+  u8g2_t *u = d.getU8g2();
+  bool ok = true;
+
+  d.setFont(u8g2_font_profont29_tr);
+  const u8g2_glyph_index_t *index = u->glyph_index;
+  for (unsigned encoding = 0; encoding < 256; encoding++) {
+    u->glyph_index = index;
+    const uint8_t *indexed = u8g2_font_get_glyph_data(u, encoding);
+    u->glyph_index = nullptr;
+    if (u8g2_font_get_glyph_data(u, encoding) != indexed) {
+      printf("FAILED: lookup of %u\n", encoding);
+      ok = false;
+    }
+  }
+
+  // readings as display() formats them for profont29
+  static char buf[256][16];
+  unsigned long glyphs = 0;
+  for (auto &b : buf) {
+    int32_t milli = static_cast<int32_t>(random_next() % 16384) - 8192;
+    glyphs += format_milli(b, sizeof(b), milli, 3, "A");
+  }
+  glyphs = glyphs * strings / 256;
+
+  for (int i = 0; i < 256; i++) {
+    static uint8_t indexed[1024];
+    u->glyph_index = index;
+    d.clearBuffer();
+    d.drawStr(0, 62, buf[i]);
+    memcpy(indexed, d.getBufferPtr(), 1024);
+    u->glyph_index = nullptr;
+    d.clearBuffer();
+    d.drawStr(0, 62, buf[i]);
+    if (memcmp(indexed, d.getBufferPtr(), 1024) != 0 && ok) {
+      printf("FAILED: \"%s\" drawn differently\n", buf[i]);
+      ok = false;
+    }
+  }
+
+  nanoseconds lookup[2], width[2], draw[2];
+  volatile unsigned long sum = 0;
+  for (int with_index = 0; with_index < 2; with_index++) {
+    u->glyph_index = with_index ? index : nullptr;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      for (const char *s = buf[i % 256]; *s != '\0'; s++)
+        sum += reinterpret_cast<uintptr_t>(u8g2_font_get_glyph_data(u, *s));
+    lookup[with_index] = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      sum += d.getStrWidth(buf[i % 256]);
+    width[with_index] = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++) {
+      d.clearBuffer();
+      d.drawStr(0, 62, buf[i % 256]);
+    }
+    draw[with_index] = std::chrono::steady_clock::now() - start;
+  }
+  u->glyph_index = index;
+
+  // the fonts of the meter screen are switched every frame; their indices
+  // are kept, one font more than U8G2_GLYPH_INDEX_FONTS rebuilds an index on
+  // every switch
+  static const uint8_t *const fonts[U8G2_GLYPH_INDEX_FONTS + 1] = {
+      u8g2_font_profont10_tr, u8g2_font_profont12_tr, u8g2_font_profont17_tr,
+      u8g2_font_profont29_tr, u8g2_font_profont22_tr};
+  static_assert(U8G2_GLYPH_INDEX_FONTS == 4, "one font per index and one more");
+  nanoseconds set_font[2];
+  for (int n = 0; n < 2; n++) {
+    unsigned count = U8G2_GLYPH_INDEX_FONTS + n;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      d.setFont(fonts[i % count]);
+    set_font[n] = std::chrono::steady_clock::now() - start;
+  }
+
+  printf("profont29, %u readings, index of %zu bytes RAM per font\n", strings,
+         sizeof(u8g2_glyph_index_t));
+  printf("                         list walk      index\n");
+  printf("  lookup per glyph    %10.1f ns %7.1f ns\n", lookup[0].count() / glyphs,
+         lookup[1].count() / glyphs);
+  printf("  getStrWidth         %10.1f ns %7.1f ns\n",
+         width[0].count() / strings, width[1].count() / strings);
+  printf("  drawStr             %10.1f ns %7.1f ns\n",
+         draw[0].count() / strings, draw[1].count() / strings);
+  printf("  setFont, index kept     %7.1f ns\n", set_font[0].count() / strings);
+  printf("  setFont, index built    %7.1f ns\n", set_font[1].count() / strings);
+  return ok ? 0 : 1;
+}
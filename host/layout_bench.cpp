@@ -0,0 +1,133 @@
+// Compares text_width() of src/text_layout.cpp with getStrWidth() for the
+// right-aligned fields of the firmware and for random strings in the
+// profont fonts, and prints the time per string of both. Exits non-zero if a
+// width differs.
+//
+//   layout_bench [<strings>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "fixed_format.h"
+#include "text_layout.h"
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+class BenchDisplay : public U8G2 {
+public:
+  BenchDisplay() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_empty,
+                                          gpio_none);
+  }
+};
+
+static const uint8_t *const fonts[] = {
+    u8g2_font_profont10_tr, u8g2_font_profont12_tr, u8g2_font_profont17_tr,
+    u8g2_font_profont29_tr};
+
+static uint32_t random_state = 1;
+
+static uint32_t random_next() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static int32_t random_milli() {
+  int32_t range[] = {1000, 100000, 10000000};
+  return static_cast<int32_t>(random_next() % (2 * range[random_next() % 3])) -
+         range[0];
+}
+
+// A string as the firmware formats it for font n: the fields of display()
+// and the header of display_graph().
+static size_t field(char *buf, size_t size, int n) {
+  switch (n) {
+  case 1:
+    if (random_next() % 2) {
+      size_t len = format_milli_auto(buf, size, random_milli(), 0,
+                                     random_next() % 2 ? 'W' : 'A');
+      return len + snprintf(buf + len, size - len, " %us",
+                            static_cast<unsigned>(random_next() % 3600));
+    }
+    return format_milli(buf, size, random_milli(), 3, "A");
+  case 2:
+    return format_milli(buf, size, random_milli(), 2, "W");
+  case 3:
+    return format_milli(buf, size, random_milli(), 3, "A");
+  default:
+    return format_milli(buf, size, random_milli(), 2, "V ", 7);
+  }
+}
+
+// Printable characters, sometimes with one outside the font at either end.
+static size_t random_string(char *buf) {
+  size_t len = 1 + random_next() % 12;
+  for (size_t i = 0; i < len; i++)
+    buf[i] = ' ' + random_next() % 95;
+  if (random_next() % 8 == 0)
+    buf[random_next() % 2 ? 0 : len - 1] = 128 + random_next() % 128;
+  buf[len] = '\0';
+  return len;
+}
+
+int main(int argc, char **argv) {
+  unsigned strings = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20000;
+  static BenchDisplay d;
+  bool ok = true;
+
+  for (int n = 0; n < 4; n++) {
+    d.setFont(fonts[n]);
+    char buf[32];
+    for (unsigned i = 0; i < strings && ok; i++) {
+      size_t len = random_string(buf);
+      // getStrWidth() of a string that starts with a glyph missing from the
+      // font adds the x offset of the glyph measured before, so both start
+      // after the same one
+      d.getStrWidth("0");
+      u8g2_uint_t width = text_width(d, buf, len);
+      d.getStrWidth("0");
+      if (width != d.getStrWidth(buf)) {
+        printf("FAILED: font %d \"%s\"\n", n, buf);
+        ok = false;
+      }
+    }
+  }
+
+  // the firmware's fields, formatted beforehand
+  static char buf[4][256][32];
+  static size_t len[4][256];
+  for (int n = 0; n < 4; n++) {
+    d.setFont(fonts[n]);
+    for (int i = 0; i < 256; i++) {
+      len[n][i] = field(buf[n][i], sizeof(buf[n][i]), n);
+      if (ok && text_width(d, buf[n][i], len[n][i]) != d.getStrWidth(buf[n][i])) {
+        printf("FAILED: font %d field \"%s\"\n", n, buf[n][i]);
+        ok = false;
+      }
+    }
+  }
+  std::chrono::duration<double, std::micro> str_width{0}, layout{0};
+  volatile unsigned long sum = 0;
+  for (int n = 0; n < 4; n++) {
+    d.setFont(fonts[n]);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      sum += d.getStrWidth(buf[n][i % 256]);
+    auto mid = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < strings; i++)
+      sum -= text_width(d, buf[n][i % 256], len[n][i % 256]);
+    auto end = std::chrono::steady_clock::now();
+    str_width += mid - start;
+    layout += end - mid;
+  }
+
+  printf("%u fields per font, profont10/12/17/29, metrics of %zu bytes RAM\n",
+         strings, LAYOUT_FONTS * sizeof(font_metrics));
+  printf("  getStrWidth  %7.1f ns/field\n", str_width.count() * 1e3 / strings / 4);
+  printf("  text_width   %7.1f ns/field\n", layout.count() * 1e3 / strings / 4);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,432 @@
+// Reads the serial streams of several meters at once.
+//
+//   meter_ingest [-b baud] /dev/ttyUSB0 /dev/ttyUSB1 ...
+//   meter_ingest --synthetic <meters> [--seconds <s>] [--rate <samples/s>]
+//
+// Every device gets a reader thread that splits and decodes the stream and
+// hands batches of samples to the aggregation thread through its own
+// lock-free SPSC queue. The aggregator prints a summary per device and
+// second. --synthetic drives the same pipeline from generated pty streams and
+// reports throughput and end-to-end latency instead.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "meter_protocol.h"
+#include "spsc_queue.h"
+
+#define BATCH_SIZE 64
+#define QUEUE_SIZE 1024
+#define LINE_MAX_LEN 64
+
+struct Batch {
+  int64_t received_ns; // host monotonic time of the read() that completed it
+  uint16_t count;
+  MeterSample samples[BATCH_SIZE];
+};
+
+struct Device {
+  std::string path;
+  int fd = -1;
+  SpscQueue<Batch, QUEUE_SIZE> queue;
+  std::atomic<uint64_t> dropped{0}; // samples lost to a full queue
+  std::atomic<uint64_t> invalid{0}; // undecodable lines
+  std::atomic<bool> eof{false};
+
+  // aggregator state
+  uint64_t samples = 0;
+  uint64_t window_samples = 0;
+  double window_ma = 0, window_mv = 0;
+};
+
+static std::atomic<bool> stop_requested{false};
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static speed_t baud_constant(int baud) {
+  switch (baud) {
+  case 9600:
+    return B9600;
+  case 19200:
+    return B19200;
+  case 38400:
+    return B38400;
+  case 57600:
+    return B57600;
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  default:
+    return 0;
+  }
+}
+
+static int open_device(const char *path, int baud) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0)
+    return -1;
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) { // plain files and pipes are used as is
+    cfmakeraw(&tio);
+    if (baud_constant(baud)) {
+      cfsetispeed(&tio, baud_constant(baud));
+      cfsetospeed(&tio, baud_constant(baud));
+    }
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+// Latency histogram with 16 sub-buckets per power of two, in microseconds.
+class LatencyHistogram {
+public:
+  void add(int64_t us) {
+    if (us < 0)
+      us = 0;
+    buckets_[bucket(static_cast<uint64_t>(us))]++;
+    count_++;
+  }
+
+  uint64_t count() const { return count_; }
+
+  int64_t percentile(double p) const {
+    uint64_t want = static_cast<uint64_t>(p / 100.0 * count_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); i++) {
+      seen += buckets_[i];
+      if (seen > want)
+        return upper_bound(i);
+    }
+    return upper_bound(buckets_.size() - 1);
+  }
+
+private:
+  static size_t bucket(uint64_t us) {
+    if (us < 16)
+      return us;
+    int msb = 63 - __builtin_clzll(us);
+    size_t sub = (us >> (msb - 4)) & 15;
+    return std::min<size_t>(16 + (msb - 4) * 16 + sub, 16 * 40 - 1);
+  }
+  static int64_t upper_bound(size_t b) {
+    if (b < 16)
+      return b;
+    int msb = static_cast<int>(b / 16) + 3;
+    return static_cast<int64_t>((16 + (b & 15) + 1)) << (msb - 4);
+  }
+
+  std::vector<uint64_t> buckets_ = std::vector<uint64_t>(16 * 40);
+  uint64_t count_ = 0;
+};
+
+static void reader(Device *dev) {
+  char buf[4096];
+  char line[LINE_MAX_LEN];
+  size_t line_len = 0;
+  Batch batch;
+  batch.count = 0;
+
+  auto flush = [&](int64_t received) {
+    if (batch.count == 0)
+      return;
+    batch.received_ns = received;
+    if (!dev->queue.push(batch))
+      dev->dropped += batch.count;
+    batch.count = 0;
+  };
+
+  while (!stop_requested) {
+    struct pollfd pfd = {dev->fd, POLLIN, 0};
+    int r = poll(&pfd, 1, 100);
+    if (r == 0)
+      continue;
+    if (r < 0 && errno == EINTR)
+      continue;
+    ssize_t n = r > 0 ? read(dev->fd, buf, sizeof(buf)) : -1;
+    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    if (n <= 0)
+      break;
+
+    int64_t received = now_ns();
+    for (ssize_t i = 0; i < n; i++) {
+      char c = buf[i];
+      if (c != '\n') {
+        if (line_len < sizeof(line))
+          line[line_len] = c;
+        line_len++;
+        continue;
+      }
+      MeterSample sample;
+      MeterStats stats;
+      FrameType type = line_len <= sizeof(line)
+                           ? parse_frame(line, line_len, &sample, &stats)
+                           : FrameType::Invalid;
+      line_len = 0;
+      if (type == FrameType::Invalid) {
+        dev->invalid++;
+        continue;
+      }
+      if (type != FrameType::Sample)
+        continue;
+      batch.samples[batch.count++] = sample;
+      if (batch.count == BATCH_SIZE)
+        flush(received);
+    }
+    flush(received);
+  }
+  dev->eof = true;
+}
+
+static void report_devices(std::vector<std::unique_ptr<Device>> &devices) {
+  for (auto &dev : devices) {
+    if (dev->window_samples == 0) {
+      printf("%s: no samples\n", dev->path.c_str());
+      continue;
+    }
+    printf("%s: %llu samples, %.1f mA, %.0f mV\n", dev->path.c_str(),
+           static_cast<unsigned long long>(dev->window_samples),
+           dev->window_ma / dev->window_samples,
+           dev->window_mv / dev->window_samples);
+    dev->window_samples = 0;
+    dev->window_ma = dev->window_mv = 0;
+  }
+  fflush(stdout);
+}
+
+// Runs until every reader has finished and its queue is drained. In
+// synthetic mode the device timestamp is the generator's clock, which gives
+// the end-to-end latency of every sample.
+static void aggregate(std::vector<std::unique_ptr<Device>> &devices,
+                      bool synthetic, LatencyHistogram *latency) {
+  int64_t next_report = now_ns() + 1000000000;
+  Batch batch;
+
+  for (;;) {
+    bool idle = true, all_done = true;
+    for (auto &dev : devices) {
+      bool done = dev->eof;
+      while (dev->queue.pop(&batch)) {
+        idle = false;
+        int64_t now = now_ns();
+        for (uint16_t i = 0; i < batch.count; i++) {
+          const MeterSample &s = batch.samples[i];
+          if (synthetic) {
+            uint32_t now_us = static_cast<uint32_t>(now / 1000);
+            latency->add(static_cast<int32_t>(now_us - s.device_us));
+          } else {
+            dev->window_ma += s.milliamps();
+            dev->window_mv += s.millivolt();
+          }
+        }
+        if (!synthetic)
+          latency->add((now - batch.received_ns) / 1000);
+        dev->samples += batch.count;
+        dev->window_samples += batch.count;
+      }
+      all_done = all_done && done;
+    }
+    if (all_done)
+      break;
+    if (!synthetic && now_ns() >= next_report) {
+      report_devices(devices);
+      next_report += 1000000000;
+    }
+    if (idle)
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+// Writes sample lines to a pty master, stamped with the low 32 bits of the
+// monotonic clock in microseconds.
+static void generator(int master, double rate, std::atomic<bool> *running) {
+  const int lines_per_write = 32;
+  char buf[lines_per_write * 18];
+  int64_t start = now_ns();
+  uint64_t sent = 0;
+
+  while (*running) {
+    if (rate > 0) {
+      int64_t due = start + static_cast<int64_t>(sent * 1e9 / rate);
+      int64_t now = now_ns();
+      if (due > now)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+    }
+    uint32_t ts = static_cast<uint32_t>(now_ns() / 1000);
+    for (int i = 0; i < lines_per_write; i++)
+      snprintf(buf + i * 18, 19, "FC6D0640%08X\x1c\n", ts);
+    size_t off = 0;
+    while (off < sizeof(buf) && *running) {
+      ssize_t n = write(master, buf + off, sizeof(buf) - off);
+      if (n < 0 && errno != EINTR && errno != EAGAIN)
+        return;
+      if (n > 0)
+        off += n;
+    }
+    sent += lines_per_write;
+  }
+}
+
+static int run_synthetic(int meters, double seconds, double rate) {
+  std::vector<std::unique_ptr<Device>> devices;
+  std::vector<int> masters;
+
+  for (int i = 0; i < meters; i++) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) {
+      perror("posix_openpt");
+      return 1;
+    }
+    auto dev = std::make_unique<Device>();
+    dev->path = ptsname(master);
+    dev->fd = open_device(dev->path.c_str(), 0);
+    if (dev->fd < 0) {
+      perror(dev->path.c_str());
+      return 1;
+    }
+    masters.push_back(master);
+    devices.push_back(std::move(dev));
+  }
+
+  std::atomic<bool> running{true};
+  std::vector<std::thread> threads;
+  for (auto &dev : devices)
+    threads.emplace_back(reader, dev.get());
+  for (int master : masters)
+    threads.emplace_back(generator, master, rate, &running);
+
+  LatencyHistogram latency;
+  std::thread agg(aggregate, std::ref(devices), true, &latency);
+
+  int64_t start = now_ns();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  running = false;
+  stop_requested = true;
+  for (auto &t : threads)
+    t.join();
+  agg.join();
+  double elapsed = (now_ns() - start) / 1e9;
+
+  uint64_t total = 0, dropped = 0, invalid = 0;
+  for (auto &dev : devices) {
+    total += dev->samples;
+    dropped += dev->dropped;
+    invalid += dev->invalid;
+    close(dev->fd);
+  }
+  for (int master : masters)
+    close(master);
+
+  printf("meters:      %d\n", meters);
+  printf("samples:     %llu (%llu dropped, %llu invalid)\n",
+         static_cast<unsigned long long>(total),
+         static_cast<unsigned long long>(dropped),
+         static_cast<unsigned long long>(invalid));
+  printf("throughput:  %.0f samples/s\n", total / elapsed);
+  printf("latency us:  p50 %lld  p90 %lld  p99 %lld  p99.9 %lld\n",
+         static_cast<long long>(latency.percentile(50)),
+         static_cast<long long>(latency.percentile(90)),
+         static_cast<long long>(latency.percentile(99)),
+         static_cast<long long>(latency.percentile(99.9)));
+  return 0;
+}
+
+static void on_signal(int) { stop_requested = true; }
+
+static void usage() {
+  fprintf(stderr, "usage: meter_ingest [-b baud] <device>...\n"
+                  "       meter_ingest --synthetic <meters> [--seconds <s>] "
+                  "[--rate <samples/s per meter>]\n");
+}
+
+int main(int argc, char **argv) {
+  int baud = 9600;
+  int synthetic = 0;
+  double seconds = 10, rate = 0;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-b" && has_value)
+      baud = atoi(argv[++i]);
+    else if (arg == "--synthetic" && has_value)
+      synthetic = atoi(argv[++i]);
+    else if (arg == "--seconds" && has_value)
+      seconds = atof(argv[++i]);
+    else if (arg == "--rate" && has_value)
+      rate = atof(argv[++i]);
+    else if (arg[0] == '-') {
+      usage();
+      return 2;
+    } else
+      paths.push_back(arg);
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  if (synthetic > 0)
+    return run_synthetic(synthetic, seconds, rate);
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+  if (baud_constant(baud) == 0) {
+    fprintf(stderr, "unsupported baud rate %d\n", baud);
+    return 2;
+  }
+
+  std::vector<std::unique_ptr<Device>> devices;
+  for (auto &path : paths) {
+    auto dev = std::make_unique<Device>();
+    dev->path = path;
+    dev->fd = open_device(path.c_str(), baud);
+    if (dev->fd < 0) {
+      perror(path.c_str());
+      return 1;
+    }
+    devices.push_back(std::move(dev));
+  }
+
+  std::vector<std::thread> readers;
+  for (auto &dev : devices)
+    readers.emplace_back(reader, dev.get());
+  LatencyHistogram latency;
+  aggregate(devices, false, &latency);
+  for (auto &t : readers)
+    t.join();
+
+  for (auto &dev : devices) {
+    fprintf(stderr, "%s: %llu samples, %llu dropped, %llu invalid\n",
+            dev->path.c_str(), static_cast<unsigned long long>(dev->samples),
+            static_cast<unsigned long long>(dev->dropped.load()),
+            static_cast<unsigned long long>(dev->invalid.load()));
+    close(dev->fd);
+  }
+  fprintf(stderr, "queue latency us: p50 %lld  p99 %lld\n",
+          static_cast<long long>(latency.percentile(50)),
+          static_cast<long long>(latency.percentile(99)));
+  return 0;
+}
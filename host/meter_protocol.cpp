@@ -0,0 +1,103 @@
+#include "meter_protocol.h"
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+static bool parse_hex(const char *s, int digits, uint32_t *out) {
+  uint32_t val = 0;
+  for (int i = 0; i < digits; i++) {
+    int v = hex_value(s[i]);
+    if (v < 0)
+      return false;
+    val = (val << 4) | static_cast<uint32_t>(v);
+  }
+  *out = val;
+  return true;
+}
+
+static size_t strip_terminator(const char *line, size_t len) {
+  while (len > 0 &&
+         (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == 28))
+    len--;
+  return len;
+}
+
+static bool parse_stats_line(const char *line, size_t len, MeterStats *out) {
+  len = strip_terminator(line, len);
+  if (len != 38 || line[0] != '=')
+    return false;
+
+  uint32_t channel, v[7], ts;
+  if (!parse_hex(line + 1, 1, &channel))
+    return false;
+  for (int i = 0; i < 7; i++) {
+    if (!parse_hex(line + 2 + 4 * i, 4, &v[i]))
+      return false;
+  }
+  if (!parse_hex(line + 30, 8, &ts))
+    return false;
+
+  out->channel = static_cast<uint8_t>(channel);
+  out->count = static_cast<uint16_t>(v[0]);
+  out->shunt_min = static_cast<int16_t>(v[1]);
+  out->shunt_max = static_cast<int16_t>(v[2]);
+  out->shunt_mean = static_cast<int16_t>(v[3]);
+  out->volt_min = static_cast<int16_t>(v[4]);
+  out->volt_max = static_cast<int16_t>(v[5]);
+  out->volt_mean = static_cast<int16_t>(v[6]);
+  out->device_us = ts;
+  return true;
+}
+
+FrameType parse_frame(const char *line, size_t len, MeterSample *sample,
+                      MeterStats *stats) {
+  if (len > 0 && line[0] == '#')
+    return FrameType::Tiles;
+  if (len > 0 && line[0] == '!')
+    return FrameType::Info;
+  if (len > 0 && line[0] == '=')
+    return parse_stats_line(line, len, stats) ? FrameType::Stats
+                                              : FrameType::Invalid;
+  return parse_sample_line(line, len, sample) ? FrameType::Sample
+                                              : FrameType::Invalid;
+}
+
+bool parse_sample_line(const char *line, size_t len, MeterSample *out) {
+  len = strip_terminator(line, len);
+  if (len != 8 && len != 16)
+    return false;
+
+  uint32_t shunt, volt, ts = 0;
+  if (!parse_hex(line, 4, &shunt) || !parse_hex(line + 4, 4, &volt))
+    return false;
+  if (len == 16 && !parse_hex(line + 8, 8, &ts))
+    return false;
+
+  out->shunt_raw = static_cast<int16_t>(shunt);
+  out->volt_raw = static_cast<int16_t>(volt);
+  out->device_us = ts;
+  out->has_timestamp = len == 16;
+  return true;
+}
+
+uint64_t TimestampUnwrapper::extend(uint32_t device_us) {
+  restarted_ = false;
+  if (started_ && device_us < last_) {
+    if (static_cast<uint32_t>(device_us - last_) <= TIMESTAMP_MAX_STEP_US) {
+      high_ += 1ULL << 32;
+    } else {
+      high_ = 0;
+      restarted_ = true;
+    }
+  }
+  started_ = true;
+  last_ = device_us;
+  return high_ | device_us;
+}
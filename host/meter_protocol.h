@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decoder for the serial frames written by stream_sample() in src/main.cpp.
+//
+// Every frame is one line terminated by "\x1c\n". A sample frame is
+// "SSSSVVVV[TTTTTTTT]": shunt and bus voltage as 16 bit hex, optionally
+// followed by the 32 bit micros() timestamp of the reading. Older firmware
+// sends no timestamp. Statistics frames start with '=', see MeterStats;
+// display mirror frames start with '#', see FrameMirror in fb_mirror.h;
+// '!' starts a human readable info frame, e.g. the answer to "timing" or
+// "profile".
+//
+// Subscriptions are changed by writing newline terminated commands:
+//   "raw off", "raw <min_interval_ms>"
+//   "stat <channel> off", "stat <channel> <samples> [min_interval_ms]"
+//   "mirror off", "mirror <min_interval_ms>"
+//   "timing", "profile"
+
+struct MeterSample {
+  int16_t shunt_raw; // -milliamps / 0.2
+  int16_t volt_raw;  // millivolt / 3.125
+  uint32_t device_us;
+  bool has_timestamp;
+
+  double milliamps() const { return -shunt_raw * 0.2; }
+  double millivolt() const { return volt_raw * 3.125; }
+};
+
+// Min/max/mean over a window of samples, in the raw units of MeterSample.
+// Note that the shunt value is negated current, so shunt_max is the lowest
+// current of the window.
+struct MeterStats {
+  uint8_t channel;
+  uint16_t count;
+  int16_t shunt_min, shunt_max, shunt_mean;
+  int16_t volt_min, volt_max, volt_mean;
+  uint32_t device_us; // timestamp of the last sample in the window
+
+  double milliamps_min() const { return -shunt_max * 0.2; }
+  double milliamps_max() const { return -shunt_min * 0.2; }
+  double milliamps_mean() const { return -shunt_mean * 0.2; }
+  double millivolt_min() const { return volt_min * 3.125; }
+  double millivolt_max() const { return volt_max * 3.125; }
+  double millivolt_mean() const { return volt_mean * 3.125; }
+};
+
+enum class FrameType { Invalid, Sample, Stats, Tiles, Info };
+
+// Parses one line of any frame type. Tile and info frames are only
+// classified; pass tile frames on to FrameMirror::apply().
+FrameType parse_frame(const char *line, size_t len, MeterSample *sample,
+                      MeterStats *stats);
+
+// Value of a hex digit (either case), -1 if c is none.
+int hex_value(char c);
+
+// Parses one sample line. Trailing '\n', '\r' and the 0x1c separator are optional.
+bool parse_sample_line(const char *line, size_t len, MeterSample *out);
+
+// The longest time between two timestamps of one meter: the raw and
+// statistics intervals are at most 0xffff ms, with some margin.
+#define TIMESTAMP_MAX_STEP_US 70000000
+
+// Extends the wrapping 32 bit micros() counter to 64 bit. micros() wraps after
+// ~71 minutes and starts again at 0 when the meter restarts. A timestamp that
+// steps back is a wrap only if it is at most TIMESTAMP_MAX_STEP_US after the
+// one before, counted across 2^32, i.e. the one before was near 2^32 and this
+// one is near 0. Any other step back is a restart: the count starts again at
+// device_us, so ClockSync::add() sees the time go back and drops its fit.
+class TimestampUnwrapper {
+public:
+  uint64_t extend(uint32_t device_us);
+  // True if the last extend() started a new count after a restart.
+  bool restarted() const { return restarted_; }
+  void reset() {
+    started_ = false;
+    restarted_ = false;
+    last_ = 0;
+    high_ = 0;
+  }
+
+private:
+  bool started_ = false;
+  bool restarted_ = false;
+  uint32_t last_ = 0;
+  uint64_t high_ = 0;
+};
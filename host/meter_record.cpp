@@ -0,0 +1,327 @@
+// Records meter samples into the columnar format of recording.h.
+//
+//   meter_record record <device> <file>    append live samples, host time
+//   meter_record import <text log> <file>  convert a log of serial lines
+//   meter_record query <file> [<from_us> <to_us>]
+//   meter_record gen <text log> <samples>  write a synthetic serial log
+//   meter_record bench <text log>          compare text log and recording
+
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+#include "clock_sync.h"
+#include "meter_protocol.h"
+#include "recording.h"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int) { stop_requested = 1; }
+
+static RecordingSample to_record(const MeterSample &s, int64_t ts_us,
+                                 uint8_t flags) {
+  RecordingSample r;
+  r.ts_us = ts_us;
+  r.current_ua = static_cast<int32_t>(s.milliamps() * 1000);
+  r.voltage_uv = static_cast<int32_t>(s.millivolt() * 1000);
+  r.flags = flags;
+  return r;
+}
+
+// Feeds every sample line of a text log to fn(sample, ts_us, flags). Lines
+// without a meter timestamp are assumed to be 50 ms after the one before.
+// After a restart of the meter its timestamps continue 50 ms after the last
+// sample, flagged RECORDING_GAP.
+template <typename Fn> static bool read_text_log(const char *path, Fn fn) {
+  FILE *f = fopen(path, "r");
+  if (f == nullptr) {
+    perror(path);
+    return false;
+  }
+  char line[128];
+  TimestampUnwrapper unwrap;
+  int64_t base = 0, last = -50000;
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    MeterSample s;
+    size_t len = strlen(line);
+    if (!parse_sample_line(line, len, &s))
+      continue;
+    int64_t ts = last + 50000;
+    uint8_t flags = 0;
+    if (s.has_timestamp) {
+      uint64_t device_us = unwrap.extend(s.device_us);
+      if (unwrap.restarted()) {
+        base = last + 50000 - static_cast<int64_t>(device_us);
+        flags = RECORDING_GAP;
+      }
+      ts = base + static_cast<int64_t>(device_us);
+    }
+    fn(s, ts, flags);
+    last = ts;
+  }
+  fclose(f);
+  return true;
+}
+
+static int cmd_import(const char *log, const char *file) {
+  RecordingWriter w;
+  if (!w.open(file)) {
+    fprintf(stderr, "%s: %s\n", file, w.error().c_str());
+    return 1;
+  }
+  bool ok = true;
+  read_text_log(log, [&](const MeterSample &s, int64_t ts, uint8_t flags) {
+    if (ok && !w.append(to_record(s, ts, flags))) {
+      fprintf(stderr, "%s: %s\n", file, w.error().c_str());
+      ok = false;
+    }
+  });
+  w.sync();
+  printf("%" PRIu64 " samples\n", w.size());
+  return ok ? 0 : 1;
+}
+
+static int64_t steady_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Records with meter time mapped to the host by ClockSync, so the samples of
+// one read() keep their spacing and a step of the wall clock does not reorder
+// them. The host clock is monotonic; the wall clock is only read once, to
+// place the recording in real time. Samples without a meter timestamp, and
+// those before the first fit, get the time of their read().
+static int cmd_record(const char *device, const char *file) {
+  int fd = open(device, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(device);
+    return 1;
+  }
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  RecordingWriter w;
+  if (!w.open(file)) {
+    fprintf(stderr, "%s: %s\n", file, w.error().c_str());
+    return 1;
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  int64_t epoch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count() -
+                     steady_ns() / 1000;
+  TimestampUnwrapper unwrap;
+  ClockSync sync;
+  int64_t last = INT64_MIN;
+  char buf[256], line[64];
+  size_t line_len = 0;
+  uint8_t gap = 0;
+  while (!stop_requested) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0)
+      break;
+    int64_t now = steady_ns();
+    for (ssize_t i = 0; i < n; i++) {
+      if (buf[i] != '\n') {
+        if (line_len < sizeof(line))
+          line[line_len] = buf[i];
+        line_len++;
+        continue;
+      }
+      MeterSample s;
+      if (line_len <= sizeof(line) && parse_sample_line(line, line_len, &s)) {
+        int64_t ts = now / 1000;
+        uint8_t flags = gap | RECORDING_HOST_TIME;
+        if (s.has_timestamp) {
+          uint64_t device_us = unwrap.extend(s.device_us);
+          if (unwrap.restarted()) {
+            sync.reset();
+            flags |= RECORDING_GAP;
+          }
+          sync.add(device_us, now);
+          if (sync.ready()) {
+            ts = sync.to_host_ns(device_us) / 1000;
+            flags &= ~RECORDING_HOST_TIME;
+          }
+        }
+        // the fit moves with every bucket; never let that step back
+        ts = ts + epoch_us > last ? ts + epoch_us : last;
+        if (w.append(to_record(s, ts, flags))) {
+          last = ts;
+          gap = 0;
+        } else {
+          gap = RECORDING_GAP;
+        }
+      }
+      line_len = 0;
+    }
+  }
+  w.sync();
+  close(fd);
+  printf("%" PRIu64 " samples\n", w.size());
+  return 0;
+}
+
+static void print_stats(const RecordingStats &st) {
+  printf("samples:  %" PRIu64 "\n", st.count);
+  if (st.count == 0)
+    return;
+  printf("time:     %" PRId64 " .. %" PRId64 " us\n", st.first_ts_us, st.last_ts_us);
+  printf("current:  min %.1f  max %.1f  mean %.1f mA\n", st.current_min / 1000.0,
+         st.current_max / 1000.0, st.current_mean() / 1000.0);
+  printf("voltage:  min %.0f  max %.0f  mean %.0f mV\n", st.voltage_min / 1000.0,
+         st.voltage_max / 1000.0, st.voltage_mean() / 1000.0);
+  printf("blocks scanned: %u\n", st.blocks_scanned);
+}
+
+static int cmd_query(const char *file, int64_t from, int64_t to) {
+  RecordingReader r;
+  if (!r.open(file)) {
+    fprintf(stderr, "%s: %s\n", file, r.error().c_str());
+    return 1;
+  }
+  print_stats(r.stats(from, to));
+  return 0;
+}
+
+static int cmd_gen(const char *log, long samples) {
+  FILE *f = fopen(log, "w");
+  if (f == nullptr) {
+    perror(log);
+    return 1;
+  }
+  uint32_t ts = 0;
+  unsigned rnd = 1;
+  for (long i = 0; i < samples; i++) {
+    rnd = rnd * 1103515245 + 12345;
+    int16_t shunt = -static_cast<int16_t>(1000 + (rnd >> 16) % 4000);
+    fprintf(f, "%04X%04X%08X\x1c\n", static_cast<uint16_t>(shunt), 1600, ts);
+    ts += 50000 + (rnd & 0xff);
+  }
+  fclose(f);
+  return 0;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+static int cmd_bench(const char *log) {
+  const int queries = 100;
+  std::string file = std::string(log) + ".bench.rec";
+  unlink(file.c_str());
+
+  // text: parse the whole log, then answer range queries from memory
+  auto t = std::chrono::steady_clock::now();
+  std::vector<RecordingSample> samples;
+  read_text_log(log, [&](const MeterSample &s, int64_t ts, uint8_t flags) {
+    samples.push_back(to_record(s, ts, flags));
+  });
+  double text_load = seconds_since(t);
+  if (samples.empty()) {
+    fprintf(stderr, "%s: no samples\n", log);
+    return 1;
+  }
+  int64_t t0 = samples.front().ts_us, span = samples.back().ts_us - t0 + 1;
+
+  t = std::chrono::steady_clock::now();
+  int64_t text_sum = 0;
+  for (int q = 0; q < queries; q++) {
+    int64_t from = t0 + span * q / (queries * 2), to = from + span / 100;
+    for (const RecordingSample &s : samples)
+      if (s.ts_us >= from && s.ts_us < to)
+        text_sum += s.current_ua;
+  }
+  double text_query = seconds_since(t);
+
+  t = std::chrono::steady_clock::now();
+  {
+    RecordingWriter w;
+    if (!w.open(file)) {
+      fprintf(stderr, "%s: %s\n", file.c_str(), w.error().c_str());
+      return 1;
+    }
+    for (const RecordingSample &s : samples)
+      w.append(s);
+  }
+  double convert = seconds_since(t);
+
+  t = std::chrono::steady_clock::now();
+  RecordingReader r;
+  if (!r.open(file)) {
+    fprintf(stderr, "%s: %s\n", file.c_str(), r.error().c_str());
+    return 1;
+  }
+  double rec_load = seconds_since(t);
+
+  t = std::chrono::steady_clock::now();
+  int64_t rec_sum = 0;
+  uint32_t scanned = 0;
+  for (int q = 0; q < queries; q++) {
+    int64_t from = t0 + span * q / (queries * 2), to = from + span / 100;
+    RecordingStats st = r.stats(from, to);
+    rec_sum += st.current_sum;
+    scanned += st.blocks_scanned;
+  }
+  double rec_query = seconds_since(t);
+  r.close();
+  unlink(file.c_str());
+
+  printf("samples:          %zu\n", samples.size());
+  printf("load      text %10.3f ms   recording %10.3f ms\n", text_load * 1e3,
+         rec_load * 1e3);
+  printf("%d queries text %10.3f ms   recording %10.3f ms (%u blocks scanned)\n",
+         queries, text_query * 1e3, rec_query * 1e3, scanned);
+  printf("conversion        %10.3f ms\n", convert * 1e3);
+  if (text_sum != rec_sum) {
+    fprintf(stderr, "result mismatch\n");
+    return 1;
+  }
+  return 0;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: meter_record record <device> <file>\n"
+          "       meter_record import <text log> <file>\n"
+          "       meter_record query <file> [<from_us> <to_us>]\n"
+          "       meter_record gen <text log> <samples>\n"
+          "       meter_record bench <text log>\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    usage();
+    return 2;
+  }
+  std::string cmd = argv[1];
+  if (cmd == "record" && argc == 4)
+    return cmd_record(argv[2], argv[3]);
+  if (cmd == "import" && argc == 4)
+    return cmd_import(argv[2], argv[3]);
+  if (cmd == "query" && argc == 3)
+    return cmd_query(argv[2], INT64_MIN, INT64_MAX);
+  if (cmd == "query" && argc == 5)
+    return cmd_query(argv[2], strtoll(argv[3], nullptr, 0),
+                     strtoll(argv[4], nullptr, 0));
+  if (cmd == "gen" && argc == 4)
+    return cmd_gen(argv[2], atol(argv[3]));
+  if (cmd == "bench" && argc == 3)
+    return cmd_bench(argv[2]);
+  usage();
+  return 2;
+}
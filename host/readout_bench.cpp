@@ -0,0 +1,179 @@
+// Compares the two backends of the meter screen for a sequence of readings:
+// the u8g2 buffer (meter_draw() of src/meter_screen.h with U8G2_FIXED, as
+// display() of src/main.cpp draws it, sent through the tile queue) and the
+// u8x8 tile readout of src/tile_readout.cpp (-DTILE_READOUT), which draws
+// voltage, power and full scale in u8x8 fonts instead of profont. Both go
+// through the SH1106 driver and the firmware's u8x8_cad_sh1106_fast_i2c()
+// into a byte procedure that counts transactions and bytes; a model of the
+// display RAM records the tiles drawn. Prints bus bytes, transactions, bus time at the display clock
+// and host CPU time per update. Exits non-zero if the display differs from
+// the buffer, or the tile readout on the display from drawing it from scratch.
+//
+//   readout_bench [<updates>]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "U8g2Fixed.h"
+#include "meter_screen.h"
+#include "tile_readout.h"
+
+struct Display {
+  u8x8_msg_cb driver;
+  uint8_t ram[8][128];
+  unsigned long transactions;
+  unsigned long bytes; // after the address byte
+};
+
+static Display displays[3];
+
+static Display &display_of(u8x8_t *u8x8) {
+  return displays[reinterpret_cast<uintptr_t>(u8x8->user_ptr)];
+}
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+static uint8_t byte_count(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *) {
+  switch (msg) {
+  case U8X8_MSG_BYTE_INIT:
+    u8x8->bus_clock = u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+    u8x8->i2c_max_transfer = 128; // ESP8266 Wire buffer
+    break;
+  case U8X8_MSG_BYTE_START_TRANSFER:
+    display_of(u8x8).transactions++;
+    break;
+  case U8X8_MSG_BYTE_SEND:
+    display_of(u8x8).bytes += arg_int;
+    break;
+  case U8X8_MSG_BYTE_SET_DC:
+  case U8X8_MSG_BYTE_END_TRANSFER:
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+// Records the drawn tiles, then runs the SH1106 driver.
+static uint8_t display_model(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int,
+                             void *arg_ptr) {
+  Display &d = display_of(u8x8);
+  if (msg == U8X8_MSG_DISPLAY_DRAW_TILE) {
+    const u8x8_tile_t *t = static_cast<const u8x8_tile_t *>(arg_ptr);
+    uint8_t x = t->x_pos;
+    for (uint8_t r = 0; r < arg_int; r++)
+      for (uint8_t i = 0; i < t->cnt && x < 16; i++, x++)
+        memcpy(&d.ram[t->y_pos][x * 8], t->tile_ptr + i * 8, 8);
+  }
+  return d.driver(u8x8, msg, arg_int, arg_ptr);
+}
+
+// The firmware's display class on the counting bus, with its own buffer (the
+// setup procedure shares one static buffer).
+class BenchDisplay
+    : public U8G2_FIXED<128, 64, U8G2_FIXED_VERTICAL_TOP_LSB, U8G2_FIXED_R0> {
+public:
+  explicit BenchDisplay(uintptr_t number) {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, setupRotation(), byte_count,
+                                          gpio_none);
+    getU8g2()->tile_buf_ptr = buf;
+    getU8x8()->cad_cb = u8x8_cad_sh1106_fast_i2c;
+    getU8x8()->user_ptr = reinterpret_cast<void *>(number);
+    displays[number].driver = getU8x8()->display_cb;
+    getU8x8()->display_cb = display_model;
+    initDisplay();
+  }
+
+private:
+  uint8_t buf[1024];
+};
+
+struct Reading {
+  int millivolt, milliamps, maxcurrent, window_min, window_max;
+};
+
+// A load that swings slowly, with noise in the last digits.
+static Reading reading(unsigned i) {
+  int noise = static_cast<int>((i * 2654435761u) >> 28) - 8;
+  int amps = 1500 + static_cast<int>(900 * sin(i / 40.0)) + noise;
+  return {5050 + noise / 4, amps, 3000, amps - 20 - noise, amps + 15 + noise};
+}
+
+// display() of src/main.cpp, without the screensaver
+static void meter(BenchDisplay &d, const Reading &r) {
+  d.clearBuffer();
+  meter_draw(d, r.millivolt, r.milliamps, r.maxcurrent, r.window_min,
+             r.window_max);
+}
+
+static void report(const char *what, const Display &d, double cpu_us,
+                   unsigned n, uint32_t bus_clock) {
+  // start, address + ack, 9 clocks per byte, stop
+  double bits = d.transactions * (1 + 9 + 1) + d.bytes * 9.0;
+  printf("  %-14s %7.1f bytes %5.1f transactions %7.0f us bus %7.2f us cpu\n",
+         what, static_cast<double>(d.bytes) / n,
+         static_cast<double>(d.transactions) / n, bits * 1e6 / bus_clock / n,
+         cpu_us / n);
+}
+
+int main(int argc, char **argv) {
+  unsigned updates = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000;
+  if (updates == 0) {
+    fprintf(stderr, "updates must be positive\n");
+    return 2;
+  }
+  static BenchDisplay u8g2_backend(0), tile_backend(1), reference(2);
+  static uint8_t shadow[1024], dirty[16];
+  u8g2_tile_queue_t queue;
+  u8g2_InitTileQueue(&queue, shadow, dirty);
+  tile_readout readout, fresh;
+  readout_invalidate(readout);
+
+  // the first frame draws everything, not counted
+  meter(u8g2_backend, reading(0));
+  u8g2_backend.queueAll(&queue);
+  while (u8g2_backend.queueStep(&queue, 14))
+    ;
+  readout_draw(readout, tile_backend.getU8x8(), 0, 0, 1, 0, 0);
+  displays[0].transactions = displays[0].bytes = 0;
+  displays[1].transactions = displays[1].bytes = 0;
+
+  bool ok = true;
+  std::chrono::duration<double, std::micro> u8g2_cpu{0}, tile_cpu{0};
+  for (unsigned i = 1; i <= updates; i++) {
+    Reading r = reading(i);
+    auto start = std::chrono::steady_clock::now();
+    meter(u8g2_backend, r);
+    u8g2_backend.queueUpdate(&queue);
+    while (u8g2_backend.queueStep(&queue, 14))
+      ;
+    auto mid = std::chrono::steady_clock::now();
+    readout_draw(readout, tile_backend.getU8x8(), r.millivolt, r.milliamps,
+                 r.maxcurrent, r.window_min, r.window_max);
+    auto end = std::chrono::steady_clock::now();
+    u8g2_cpu += mid - start;
+    tile_cpu += end - mid;
+
+    if (ok && memcmp(displays[0].ram, u8g2_backend.getBufferPtr(), 1024) != 0) {
+      printf("FAILED: display differs from the buffer at update %u\n", i);
+      ok = false;
+    }
+    readout_invalidate(fresh);
+    readout_draw(fresh, reference.getU8x8(), r.millivolt, r.milliamps,
+                 r.maxcurrent, r.window_min, r.window_max);
+    if (ok && memcmp(displays[1].ram, displays[2].ram, 1024) != 0) {
+      printf("FAILED: tile readout differs from a full draw at update %u\n", i);
+      ok = false;
+    }
+  }
+
+  uint32_t clock = u8g2_backend.getU8x8()->bus_clock;
+  printf("%u meter screen updates, display at %lu Hz\n", updates,
+         static_cast<unsigned long>(clock));
+  report("u8g2 buffer", displays[0], u8g2_cpu.count(), updates, clock);
+  report("tile readout", displays[1], tile_cpu.count(), updates, clock);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+#include "recording.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File layout, host byte order:
+//   header        one page
+//   block index   max_blocks * RecordingBlockIndex, rounded up to a page
+//   blocks        RECORDING_BLOCK_SAMPLES * (8 + 4 + 4 + 1) bytes each:
+//                 int64 ts_us[], int32 current_ua[], int32 voltage_uv[],
+//                 uint8 flags[]
+
+#define PAGE_SIZE_BYTES 4096
+#define RECORDING_VERSION 1
+#define GROW_BLOCKS 16
+
+static const char recording_magic[8] = {'M', 'W', 'C', 'O', 'L', 'R', 'E', 'C'};
+
+struct RecordingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t block_samples;
+  uint32_t max_blocks;
+  uint32_t reserved;
+  uint64_t sample_count; // published after the sample data is written
+};
+
+static const size_t block_bytes = RECORDING_BLOCK_SAMPLES * 17UL;
+
+static size_t index_bytes(uint32_t max_blocks) {
+  size_t n = max_blocks * sizeof(RecordingBlockIndex);
+  return (n + PAGE_SIZE_BYTES - 1) & ~static_cast<size_t>(PAGE_SIZE_BYTES - 1);
+}
+
+static size_t data_offset(uint32_t max_blocks) {
+  return PAGE_SIZE_BYTES + index_bytes(max_blocks);
+}
+
+static bool header_valid(const RecordingHeader *h, size_t file_size) {
+  return file_size >= PAGE_SIZE_BYTES &&
+         memcmp(h->magic, recording_magic, sizeof(recording_magic)) == 0 &&
+         h->version == RECORDING_VERSION &&
+         h->block_samples == RECORDING_BLOCK_SAMPLES && h->max_blocks > 0 &&
+         file_size >= data_offset(h->max_blocks);
+}
+
+static RecordingHeader *header_of(uint8_t *base) {
+  return reinterpret_cast<RecordingHeader *>(base);
+}
+
+static RecordingBlockIndex *index_of(uint8_t *base) {
+  return reinterpret_cast<RecordingBlockIndex *>(base + PAGE_SIZE_BYTES);
+}
+
+/*============================================*/
+
+bool RecordingWriter::map(size_t length) {
+  if (base_ != nullptr)
+    munmap(base_, mapped_);
+  void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    base_ = nullptr;
+    mapped_ = 0;
+    error_ = strerror(errno);
+    return false;
+  }
+  base_ = static_cast<uint8_t *>(p);
+  mapped_ = length;
+  return true;
+}
+
+bool RecordingWriter::open(const std::string &path, uint32_t max_blocks) {
+  close();
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    error_ = strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    error_ = strerror(errno);
+    close();
+    return false;
+  }
+
+  if (st.st_size == 0) {
+    size_t length = data_offset(max_blocks);
+    if (ftruncate(fd_, length) != 0 || !map(length)) {
+      error_ = strerror(errno);
+      close();
+      return false;
+    }
+    RecordingHeader *h = header_of(base_);
+    memcpy(h->magic, recording_magic, sizeof(recording_magic));
+    h->version = RECORDING_VERSION;
+    h->block_samples = RECORDING_BLOCK_SAMPLES;
+    h->max_blocks = max_blocks;
+    h->sample_count = 0;
+    return true;
+  }
+
+  if (!map(st.st_size)) {
+    close();
+    return false;
+  }
+  if (!header_valid(header_of(base_), mapped_)) {
+    error_ = "not a recording";
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool RecordingWriter::append(const RecordingSample &sample) {
+  if (base_ == nullptr)
+    return false;
+  RecordingHeader *h = header_of(base_);
+  uint64_t n = h->sample_count;
+  uint32_t b = static_cast<uint32_t>(n / RECORDING_BLOCK_SAMPLES);
+  uint32_t i = static_cast<uint32_t>(n % RECORDING_BLOCK_SAMPLES);
+  if (b >= h->max_blocks) {
+    error_ = "recording full";
+    return false;
+  }
+  if (n > 0 && sample.ts_us < index_of(base_)[(n - 1) / RECORDING_BLOCK_SAMPLES].last_ts_us) {
+    error_ = "timestamp goes backwards";
+    return false;
+  }
+
+  size_t offset = data_offset(h->max_blocks);
+  size_t needed = offset + (b + 1) * block_bytes;
+  if (needed > mapped_) {
+    size_t length = offset + (b + GROW_BLOCKS) * block_bytes;
+    if (ftruncate(fd_, length) != 0) {
+      error_ = strerror(errno);
+      return false;
+    }
+    if (!map(length))
+      return false;
+    h = header_of(base_);
+  }
+
+  uint8_t *block = base_ + offset + b * block_bytes;
+  reinterpret_cast<int64_t *>(block)[i] = sample.ts_us;
+  reinterpret_cast<int32_t *>(block + RECORDING_BLOCK_SAMPLES * 8)[i] = sample.current_ua;
+  reinterpret_cast<int32_t *>(block + RECORDING_BLOCK_SAMPLES * 12)[i] = sample.voltage_uv;
+  block[RECORDING_BLOCK_SAMPLES * 16 + i] = sample.flags;
+
+  RecordingBlockIndex &idx = index_of(base_)[b];
+  if (i == 0) {
+    idx.first_ts_us = sample.ts_us;
+    idx.count = 0;
+    idx.current_min = idx.current_max = sample.current_ua;
+    idx.voltage_min = idx.voltage_max = sample.voltage_uv;
+    idx.current_sum = idx.voltage_sum = 0;
+  }
+  idx.last_ts_us = sample.ts_us;
+  idx.count = i + 1;
+  if (sample.current_ua < idx.current_min)
+    idx.current_min = sample.current_ua;
+  if (sample.current_ua > idx.current_max)
+    idx.current_max = sample.current_ua;
+  if (sample.voltage_uv < idx.voltage_min)
+    idx.voltage_min = sample.voltage_uv;
+  if (sample.voltage_uv > idx.voltage_max)
+    idx.voltage_max = sample.voltage_uv;
+  idx.current_sum += sample.current_ua;
+  idx.voltage_sum += sample.voltage_uv;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  h->sample_count = n + 1;
+  return true;
+}
+
+void RecordingWriter::sync() {
+  if (base_ != nullptr)
+    msync(base_, mapped_, MS_SYNC);
+}
+
+void RecordingWriter::close() {
+  if (base_ != nullptr) {
+    munmap(base_, mapped_);
+    base_ = nullptr;
+    mapped_ = 0;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+uint64_t RecordingWriter::size() const {
+  return base_ ? header_of(base_)->sample_count : 0;
+}
+
+/*============================================*/
+
+bool RecordingReader::open(const std::string &path) {
+  close();
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    error_ = strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || st.st_size < PAGE_SIZE_BYTES) {
+    error_ = "not a recording";
+    close();
+    return false;
+  }
+  void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    error_ = strerror(errno);
+    close();
+    return false;
+  }
+  base_ = static_cast<const uint8_t *>(p);
+  mapped_ = st.st_size;
+  if (!header_valid(reinterpret_cast<const RecordingHeader *>(base_), mapped_)) {
+    error_ = "not a recording";
+    close();
+    return false;
+  }
+  return true;
+}
+
+void RecordingReader::close() {
+  if (base_ != nullptr) {
+    munmap(const_cast<uint8_t *>(base_), mapped_);
+    base_ = nullptr;
+    mapped_ = 0;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+uint64_t RecordingReader::size() const {
+  if (base_ == nullptr)
+    return 0;
+  const RecordingHeader *h = reinterpret_cast<const RecordingHeader *>(base_);
+  uint64_t n = h->sample_count;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // the writer may have grown the file after we mapped it
+  uint64_t mapped_blocks = (mapped_ - data_offset(h->max_blocks)) / block_bytes;
+  if (n > mapped_blocks * RECORDING_BLOCK_SAMPLES)
+    n = mapped_blocks * RECORDING_BLOCK_SAMPLES;
+  return n;
+}
+
+uint32_t RecordingReader::block_count() const {
+  return static_cast<uint32_t>((size() + RECORDING_BLOCK_SAMPLES - 1) / RECORDING_BLOCK_SAMPLES);
+}
+
+const RecordingBlockIndex &RecordingReader::block(uint32_t n) const {
+  return reinterpret_cast<const RecordingBlockIndex *>(base_ + PAGE_SIZE_BYTES)[n];
+}
+
+RecordingSample RecordingReader::sample(uint32_t b, uint32_t i) const {
+  const RecordingHeader *h = reinterpret_cast<const RecordingHeader *>(base_);
+  const uint8_t *block = base_ + data_offset(h->max_blocks) + b * block_bytes;
+  RecordingSample s;
+  s.ts_us = reinterpret_cast<const int64_t *>(block)[i];
+  s.current_ua = reinterpret_cast<const int32_t *>(block + RECORDING_BLOCK_SAMPLES * 8)[i];
+  s.voltage_uv = reinterpret_cast<const int32_t *>(block + RECORDING_BLOCK_SAMPLES * 12)[i];
+  s.flags = block[RECORDING_BLOCK_SAMPLES * 16 + i];
+  return s;
+}
+
+// First block that may hold samples at or after from_us.
+uint32_t RecordingReader::first_block(int64_t from_us) const {
+  uint32_t lo = 0, hi = block_count();
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (block(mid).last_ts_us < from_us)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+RecordingStats RecordingReader::stats(int64_t from_us, int64_t to_us) const {
+  RecordingStats st;
+  auto merge = [&st](int64_t first, int64_t last, uint64_t count, int32_t cmin,
+                     int32_t cmax, int32_t vmin, int32_t vmax, int64_t csum,
+                     int64_t vsum) {
+    if (st.count == 0) {
+      st.first_ts_us = first;
+      st.current_min = cmin;
+      st.current_max = cmax;
+      st.voltage_min = vmin;
+      st.voltage_max = vmax;
+    }
+    st.last_ts_us = last;
+    st.count += count;
+    if (cmin < st.current_min)
+      st.current_min = cmin;
+    if (cmax > st.current_max)
+      st.current_max = cmax;
+    if (vmin < st.voltage_min)
+      st.voltage_min = vmin;
+    if (vmax > st.voltage_max)
+      st.voltage_max = vmax;
+    st.current_sum += csum;
+    st.voltage_sum += vsum;
+  };
+
+  uint32_t blocks = block_count();
+  for (uint32_t b = first_block(from_us); b < blocks; b++) {
+    const RecordingBlockIndex &idx = block(b);
+    if (idx.first_ts_us >= to_us)
+      break;
+    if (idx.first_ts_us >= from_us && idx.last_ts_us < to_us) {
+      merge(idx.first_ts_us, idx.last_ts_us, idx.count, idx.current_min,
+            idx.current_max, idx.voltage_min, idx.voltage_max, idx.current_sum,
+            idx.voltage_sum);
+      continue;
+    }
+    st.blocks_scanned++;
+    for (uint32_t i = 0; i < idx.count; i++) {
+      RecordingSample s = sample(b, i);
+      if (s.ts_us < from_us || s.ts_us >= to_us)
+        continue;
+      merge(s.ts_us, s.ts_us, 1, s.current_ua, s.current_ua, s.voltage_uv,
+            s.voltage_uv, s.current_ua, s.voltage_uv);
+    }
+  }
+  return st;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Append-only, memory-mapped columnar recording of meter samples.
+//
+// The file starts with a header page and a fixed-size block index, followed
+// by the data blocks. Each block holds RECORDING_BLOCK_SAMPLES samples stored
+// column by column (timestamps, current, voltage, flags). The index keeps
+// time range and min/max/sum per block, so range queries read the index and
+// only the blocks that are partially covered by the range.
+//
+// Timestamps are microseconds and must not decrease. A single writer may
+// append while readers reopen the file to see new samples.
+
+#define RECORDING_BLOCK_SAMPLES 4096
+
+enum RecordingFlags : uint8_t {
+  RECORDING_HOST_TIME = 1, // timestamp taken on the host, not the meter
+  RECORDING_GAP = 2,       // samples were lost before this one
+};
+
+struct RecordingSample {
+  int64_t ts_us;
+  int32_t current_ua;
+  int32_t voltage_uv;
+  uint8_t flags;
+};
+
+struct RecordingBlockIndex {
+  int64_t first_ts_us;
+  int64_t last_ts_us;
+  uint32_t count;
+  int32_t current_min, current_max;
+  int32_t voltage_min, voltage_max;
+  int64_t current_sum;
+  int64_t voltage_sum;
+};
+
+struct RecordingStats {
+  uint64_t count = 0;
+  int64_t first_ts_us = 0, last_ts_us = 0;
+  int32_t current_min = 0, current_max = 0;
+  int32_t voltage_min = 0, voltage_max = 0;
+  int64_t current_sum = 0, voltage_sum = 0;
+  uint32_t blocks_scanned = 0; // blocks whose samples had to be read
+
+  double current_mean() const { return count ? double(current_sum) / count : 0; }
+  double voltage_mean() const { return count ? double(voltage_sum) / count : 0; }
+};
+
+class RecordingWriter {
+public:
+  ~RecordingWriter() { close(); }
+
+  // Creates the file or continues appending to an existing recording.
+  // max_blocks fixes the size of the index and so the maximum length of the
+  // recording (65536 blocks are 268M samples, about five months at 20 Hz).
+  bool open(const std::string &path, uint32_t max_blocks = 65536);
+  bool append(const RecordingSample &sample);
+  // Makes everything appended so far durable.
+  void sync();
+  void close();
+
+  uint64_t size() const;
+  const std::string &error() const { return error_; }
+
+private:
+  bool map(size_t length);
+
+  int fd_ = -1;
+  uint8_t *base_ = nullptr;
+  size_t mapped_ = 0;
+  std::string error_;
+};
+
+class RecordingReader {
+public:
+  ~RecordingReader() { close(); }
+
+  bool open(const std::string &path);
+  void close();
+
+  uint64_t size() const;
+  uint32_t block_count() const;
+  const RecordingBlockIndex &block(uint32_t n) const;
+
+  // Statistics over all samples with from_us <= ts_us < to_us.
+  RecordingStats stats(int64_t from_us, int64_t to_us) const;
+
+  // Calls fn(const RecordingSample &) for every sample in [from_us, to_us).
+  template <typename Fn> void scan(int64_t from_us, int64_t to_us, Fn fn) const {
+    for (uint32_t b = first_block(from_us); b < block_count(); b++) {
+      const RecordingBlockIndex &idx = block(b);
+      if (idx.first_ts_us >= to_us)
+        break;
+      for (uint32_t i = 0; i < idx.count; i++) {
+        RecordingSample s = sample(b, i);
+        if (s.ts_us >= from_us && s.ts_us < to_us)
+          fn(s);
+      }
+    }
+  }
+
+  RecordingSample sample(uint32_t block, uint32_t n) const;
+  const std::string &error() const { return error_; }
+
+private:
+  uint32_t first_block(int64_t from_us) const;
+
+  int fd_ = -1;
+  const uint8_t *base_ = nullptr;
+  size_t mapped_ = 0;
+  std::string error_;
+};
@@ -0,0 +1,153 @@
+// Renders the meter screen (src/meter_screen.h) with U8G2 and with the
+// compile-time specialized U8G2_FIXED (lib/u8g2/U8g2Fixed.h) into the full
+// buffer of an SH1106 and prints the time per frame. Also draws random
+// primitives and strings with both, in R0 and R2, with clip windows, draw
+// colors and font modes, and exits non-zero if a buffer differs.
+//
+//   render_bench [<frames>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "U8g2Fixed.h"
+#include "meter_screen.h"
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+// The setup procedures share one static buffer per size, so that each
+// display gets its own.
+class PlainDisplay : public U8G2 {
+public:
+  explicit PlainDisplay(const u8g2_cb_t *rotation) {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, rotation, u8x8_byte_empty,
+                                          gpio_none);
+    getU8g2()->tile_buf_ptr = buf;
+  }
+
+private:
+  uint8_t buf[1024];
+};
+
+template <u8g2_fixed_rotation_t rotation>
+class FixedDisplay
+    : public U8G2_FIXED<128, 64, U8G2_FIXED_VERTICAL_TOP_LSB, rotation> {
+public:
+  FixedDisplay() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&this->u8g2, this->setupRotation(),
+                                          u8x8_byte_empty, gpio_none);
+    this->getU8g2()->tile_buf_ptr = buf;
+  }
+
+private:
+  uint8_t buf[1024];
+};
+
+// display() for one set of readings, without the screensaver
+template <class D>
+static void meter(D &d, int millivolt, int milliamps, int maxcurrent) {
+  d.clearBuffer();
+  meter_draw(d, millivolt, milliamps, maxcurrent, milliamps / 2, milliamps);
+}
+
+template <class D> static double frame_us(D &d, int frames) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++)
+    meter(d, 5000 + i % 15000, i % 3000, 3000);
+  std::chrono::duration<double, std::micro> t =
+      std::chrono::steady_clock::now() - start;
+  return t.count() / frames;
+}
+
+// one random drawing call, the same on both displays
+template <class D> static void random_op(D &d, unsigned seed) {
+  srand(seed);
+  const uint8_t *fonts[] = {u8g2_font_profont12_tr, u8g2_font_profont17_tr,
+                            u8g2_font_profont29_tr};
+  int x = rand() % 150 - 10, y = rand() % 90 - 10;
+  int w = rand() % 60, h = rand() % 40;
+  d.setDrawColor(rand() % 3);
+  d.setFontMode(rand() % 2);
+  if (rand() % 8 == 0)
+    d.setClipWindow(rand() % 64, rand() % 32, 64 + rand() % 64, 32 + rand() % 32);
+  else
+    d.setMaxClipWindow();
+  switch (rand() % 6) {
+  case 0:
+    d.drawPixel(x, y);
+    break;
+  case 1:
+    d.drawHLine(x, y, w);
+    break;
+  case 2:
+    d.drawVLine(x, y, h);
+    break;
+  case 3:
+    d.drawBox(x, y, w, h);
+    break;
+  case 4:
+    rand() % 2 ? d.drawLine(x, y, x + w, y) : d.drawLine(x, y + h, x, y);
+    break;
+  default: {
+    char s[8];
+    for (int i = 0; i < 7; i++)
+      s[i] = ' ' + rand() % 95;
+    s[7] = '\0';
+    d.setFont(fonts[rand() % 3]);
+    d.drawStr(x, y, s);
+  }
+  }
+}
+
+template <u8g2_fixed_rotation_t rotation>
+static bool same_result(const u8g2_cb_t *plain_rotation) {
+  PlainDisplay plain(plain_rotation);
+  FixedDisplay<rotation> fixed;
+  plain.clearBuffer();
+  fixed.clearBuffer();
+  for (unsigned seed = 1; seed <= 20000; seed++) {
+    random_op(plain, seed);
+    random_op(fixed, seed);
+    if (memcmp(plain.getBufferPtr(), fixed.getBufferPtr(), 1024) != 0) {
+      printf("FAILED: %s buffers differ after operation %u\n",
+             rotation == U8G2_FIXED_R0 ? "R0" : "R2", seed);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20000;
+  if (frames <= 0) {
+    fprintf(stderr, "frames must be positive\n");
+    return 2;
+  }
+  PlainDisplay plain(U8G2_R0);
+  FixedDisplay<U8G2_FIXED_R0> fixed;
+
+  meter(plain, 12345, 1234, 3000);
+  meter(fixed, 12345, 1234, 3000);
+  bool ok = memcmp(plain.getBufferPtr(), fixed.getBufferPtr(), 1024) == 0;
+  if (!ok)
+    printf("FAILED: meter screen differs\n");
+
+  // best of 5, the glyph cache is warm after the first run
+  double plain_us = 1e9, fixed_us = 1e9;
+  for (int run = 0; run < 5; run++) {
+    double t = frame_us(plain, frames);
+    if (t < plain_us)
+      plain_us = t;
+    t = frame_us(fixed, frames);
+    if (t < fixed_us)
+      fixed_us = t;
+  }
+  printf("meter screen  U8G2 %6.2f us/frame  U8G2_FIXED %6.2f us/frame  "
+         "(%.2fx)\n",
+         plain_us, fixed_us, plain_us / fixed_us);
+
+  ok = same_result<U8G2_FIXED_R0>(U8G2_R0) && ok;
+  ok = same_result<U8G2_FIXED_R2>(U8G2_R2) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+// Minimal Arduino environment for compiling firmware modules into host
+// simulations (see bus_sim.cpp). The simulation provides the functions.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint32_t micros();
+uint32_t millis();
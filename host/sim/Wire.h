@@ -0,0 +1,23 @@
+// Simulated Wire: transactions take the bus time of their bytes at the
+// current clock (see bus_sim.cpp).
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUFFER_LENGTH 128
+
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t hz);
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t b);
+  size_t write(const uint8_t *data, size_t n);
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t n);
+  int read() { return 0; }
+  int available() { return 0; }
+};
+
+extern TwoWire Wire;
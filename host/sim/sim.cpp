@@ -0,0 +1,49 @@
+#include "sim.h"
+
+#include "Arduino.h"
+#include "Wire.h"
+
+double sim_us = 0;
+uint32_t sim_wire_overflows = 0;
+
+static uint32_t wire_clock = 100000;
+static size_t wire_bytes = 0;
+
+uint32_t micros() { return static_cast<uint32_t>(sim_us); }
+uint32_t millis() { return static_cast<uint32_t>(sim_us / 1000); }
+
+TwoWire Wire;
+
+// start, address + ack, 9 clocks per byte, stop
+static void bus_time(size_t bytes) {
+  sim_us += (2 + 9 * (1 + bytes)) * 1e6 / wire_clock;
+}
+
+void TwoWire::setClock(uint32_t hz) { wire_clock = hz; }
+void TwoWire::beginTransmission(uint8_t) { wire_bytes = 0; }
+
+size_t TwoWire::write(uint8_t) {
+  if (wire_bytes == BUFFER_LENGTH) {
+    sim_wire_overflows++;
+    return 0;
+  }
+  wire_bytes++;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t n) {
+  size_t written = 0;
+  for (size_t i = 0; i < n; i++)
+    written += write(data[i]);
+  return written;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  bus_time(wire_bytes);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t n) {
+  bus_time(n);
+  return n;
+}
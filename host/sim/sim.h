@@ -0,0 +1,9 @@
+// Virtual clock and simulated Wire for host simulations of firmware modules
+// (see bus_sim.cpp). Every Wire transaction advances the clock by the bit
+// time of its bytes at the current bus clock.
+#pragma once
+
+#include <stdint.h>
+
+extern double sim_us;             // virtual time in microseconds
+extern uint32_t sim_wire_overflows; // writes beyond BUFFER_LENGTH
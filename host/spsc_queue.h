@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Capacity must be a power of two; one slot stays empty.
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+public:
+  // Producer side. Returns false if the queue is full.
+  bool push(const T &item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t next = (head + 1) & (Capacity - 1);
+    if (next == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (next == tail_cache_)
+        return false;
+    }
+    slots_[head] = item;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the queue is empty.
+  bool pop(T *item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_cache_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail == head_cache_)
+        return false;
+    }
+    *item = std::move(slots_[tail]);
+    tail_.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+    return true;
+  }
+
+private:
+  // head_ and its cache belong to the producer, tail_ and its cache to the
+  // consumer; keep them on separate cache lines.
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_ = 0;
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_ = 0;
+  alignas(64) T slots_[Capacity];
+};
@@ -0,0 +1,120 @@
+// Simulates the display transfer of the firmware's loop() on the virtual
+// clock of host/sim: the full u8g2 buffer of the SH1106 goes through the
+// bus arbiter (src/i2c_bus.cpp) onto the simulated Wire. Every frame changes
+// all tiles (worst case). Compares sending a frame in one call with the tile
+// queue of u8g2_QueueUpdate() / u8g2_QueueStep(), which the loop steps once
+// per pass. Reports frames per second, the longest time the loop is held in a
+// transfer call and the share of time the loop is free for other work, and
+// checks that a step of FRAME_STEP_TILES (src/main.cpp) is one transaction.
+//
+//   transfer_sim
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+#include "i2c_bus.h"
+#include "sim.h"
+
+extern "C" {
+#include "clib/u8g2.h"
+}
+
+#define SIM_US 10000000
+
+static uint8_t gpio_none(u8x8_t *, uint8_t, uint8_t, void *) { return 1; }
+
+struct Result {
+  double frames_per_s;
+  double longest_call_us;
+  double free_percent;
+  uint32_t step_transactions; // most display transactions of one call
+};
+
+// max_tiles 0: the whole frame with u8g2_UpdateDisplayDiff()
+static Result run(u8g2_t *u8g2, uint32_t frame_us, uint8_t max_tiles) {
+  static uint8_t shadow[1024], dirty[16];
+  uint8_t *buf = u8g2_GetBufferPtr(u8g2);
+  memset(buf, 0, 1024);
+  memset(shadow, 0, sizeof(shadow));
+  memset(dirty, 0, sizeof(dirty));
+  u8g2_tile_queue_t queue;
+  u8g2_InitTileQueue(&queue, shadow, dirty);
+
+  sim_us = 0;
+  double next_frame = 0, longest = 0, busy = 0;
+  uint32_t step_transactions = 0;
+  unsigned long frames = 0, rendered = 0;
+  bool frame_pending = false;
+  while (sim_us < SIM_US) {
+    double start = sim_us;
+    uint32_t transactions = bus_device_stats(0).transactions;
+    if (frame_pending) {
+      if (!u8g2_QueueStep(u8g2, &queue, max_tiles)) {
+        frame_pending = false;
+        frames++;
+      }
+    } else if (sim_us >= next_frame) {
+      next_frame += frame_us;
+      if (next_frame < sim_us)
+        next_frame = sim_us;
+      memset(buf, ++rendered & 1 ? 0x55 : 0xaa, 1024); // "render"
+      if (max_tiles == 0) {
+        u8g2_UpdateDisplayDiff(u8g2, shadow);
+        frames++;
+      } else {
+        u8g2_QueueUpdate(u8g2, &queue);
+        frame_pending = true;
+      }
+    } else {
+      sim_us = next_frame; // idle
+      continue;
+    }
+    double call = sim_us - start;
+    busy += call;
+    if (call > longest)
+      longest = call;
+    transactions = bus_device_stats(0).transactions - transactions;
+    if (transactions > step_transactions)
+      step_transactions = transactions;
+  }
+  return {frames * 1e6 / sim_us, longest, 100 - busy * 100 / sim_us,
+          step_transactions};
+}
+
+int main() {
+  static u8g2_t u8g2;
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_bus_i2c,
+                                         gpio_none);
+  u8g2_GetU8x8(&u8g2)->cad_cb = u8x8_cad_sh1106_fast_i2c;
+  u8g2_InitDisplay(&u8g2);
+
+  bool ok = true;
+  printf("display %lu Hz, all tiles change every frame\n",
+         static_cast<unsigned long>(u8g2_GetU8x8(&u8g2)->bus_clock));
+  for (uint32_t frame_us : {150000u, 0u}) {
+    printf("frame interval %lu us\n", static_cast<unsigned long>(frame_us));
+    for (uint8_t max_tiles : {0, 16, 14, 4}) {
+      Result r = run(&u8g2, frame_us, max_tiles);
+      if (max_tiles == 0)
+        printf("  whole frame       ");
+      else
+        printf("  queue, %2u tiles   ", max_tiles);
+      printf("%6.2f frames/s  longest call %6.0f us  loop free %5.1f%%  "
+             "transactions/call %lu\n",
+             r.frames_per_s, r.longest_call_us, r.free_percent,
+             static_cast<unsigned long>(r.step_transactions));
+      // FRAME_STEP_TILES of src/main.cpp must fit into one transaction
+      if (max_tiles == 14 && r.step_transactions > 1) {
+        printf("  FAILED: a step takes more than one transaction\n");
+        ok = false;
+      }
+    }
+  }
+  if (sim_wire_overflows != 0) {
+    printf("FAILED: %lu writes beyond the Wire buffer\n",
+           static_cast<unsigned long>(sim_wire_overflows));
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/*
+
+  U8g2Fixed.h
+
+  U8G2 for a single display with a full frame buffer, where the display size,
+  buffer layout and rotation are template parameters.
+
+  Universal 8bit Graphics Library (https://github.com/olikraus/u8g2/)
+
+  Copyright (c) 2016, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list
+    of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice, this
+    list of conditions and the following disclaimer in the documentation and/or other
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+  Note:
+  The drawing procedures of U8G2 go through the rotation callback (cb->draw_l90),
+  the buffer procedure (ll_hvline) and the clipping of u8g2_DrawHVLine() for
+  every line. U8G2_FIXED knows the buffer geometry at compile time and writes
+  pixel, lines, boxes and glyphs (R0 only, from the glyph cache) directly into
+  the buffer, if they are completely inside the clip window. Everything else
+  goes to the U8G2 procedures, so the result is always the same.
+
+  A derived class sets up the display in its constructor, with a full buffer
+  (_f) setup procedure whose size and buffer layout match the template
+  parameters, and with setupRotation():
+
+    class U8G2_SH1106_128X64_NONAME_F_FAST_HW_I2C :
+      public U8G2_FIXED<128, 64, U8G2_FIXED_VERTICAL_TOP_LSB, U8G2_FIXED_R0> {
+      public: U8G2_SH1106_128X64_NONAME_F_FAST_HW_I2C() {
+        u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, setupRotation(), u8x8_byte_arduino_hw_i2c, u8x8_gpio_and_delay_arduino);
+        u8x8_SetPin_HW_I2C(getU8x8(), U8X8_PIN_NONE, U8X8_PIN_NONE, U8X8_PIN_NONE);
+      }
+    };
+
+*/
+
+
+#ifndef U8G2FIXED_HH
+#define U8G2FIXED_HH
+
+#include <string.h>
+
+#include "U8g2lib.h"
+
+/* buffer layout, see u8g2_ll_hvline.c */
+enum u8g2_fixed_layout_t
+{
+  U8G2_FIXED_VERTICAL_TOP_LSB		/* u8g2_ll_hvline_vertical_top_lsb, SSD13xx, SH1106 */
+};
+
+enum u8g2_fixed_rotation_t
+{
+  U8G2_FIXED_R0,
+  U8G2_FIXED_R2
+};
+
+template <u8g2_uint_t width, u8g2_uint_t height, u8g2_fixed_layout_t layout, u8g2_fixed_rotation_t rotation>
+class U8G2_FIXED : public U8G2
+{
+  static_assert(layout == U8G2_FIXED_VERTICAL_TOP_LSB, "unsupported buffer layout");
+  static_assert(height % 8 == 0, "height must be a multiple of 8");
+
+  public:
+    static const u8g2_cb_t *setupRotation(void) { return rotation == U8G2_FIXED_R0 ? U8G2_R0 : U8G2_R2; }
+
+    void clearBuffer(void) { memset(u8g2.tile_buf_ptr, 0, width * height / 8); }
+
+    void drawPixel(u8g2_uint_t x, u8g2_uint_t y)
+      { if ( inside(x, y, 1, 1) ) fill(bufX(x, 1), bufY(y, 1), 1, 1); }
+    void drawHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w)
+      { if ( inside(x, y, w, 1) ) fill(bufX(x, w), bufY(y, 1), w, 1); else U8G2::drawHLine(x, y, w); }
+    void drawVLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t h)
+      { if ( inside(x, y, 1, h) ) fill(bufX(x, 1), bufY(y, h), 1, h); else U8G2::drawVLine(x, y, h); }
+    void drawBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+      { if ( inside(x, y, w, h) ) fill(bufX(x, w), bufY(y, h), w, h); else U8G2::drawBox(x, y, w, h); }
+
+    /* horizontal and vertical lines include both end points, like u8g2_DrawLine() */
+    void drawLine(u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t x2, u8g2_uint_t y2)
+    {
+      u8g2_uint_t lo;
+      int len;		/* the line may be longer than u8g2_uint_t */
+      if ( y1 == y2 )
+      {
+        lo = x1 < x2 ? x1 : x2;
+        len = (x1 < x2 ? x2 : x1) - lo + 1;
+        if ( inside(lo, y1, len, 1) )
+          return fill(bufX(lo, len), bufY(y1, 1), len, 1);
+      }
+      else if ( x1 == x2 )
+      {
+        lo = y1 < y2 ? y1 : y2;
+        len = (y1 < y2 ? y2 : y1) - lo + 1;
+        if ( inside(x1, lo, 1, len) )
+          return fill(bufX(x1, 1), bufY(lo, len), 1, len);
+      }
+      U8G2::drawLine(x1, y1, x2, y2);
+    }
+
+    u8g2_uint_t drawGlyph(u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding)
+    {
+      if ( !isDirectFont() )
+        return U8G2::drawGlyph(x, y, encoding);
+      return glyph(x, y, y + u8g2.font_calc_vref(&u8g2), encoding);
+    }
+
+    u8g2_uint_t drawStr(u8g2_uint_t x, u8g2_uint_t y, const char *s)
+    {
+      u8g2_uint_t ref_y, dx, sum = 0;
+      if ( !isDirectFont() )
+        return U8G2::drawStr(x, y, s);
+      ref_y = y + u8g2.font_calc_vref(&u8g2);
+      /* same end of string as u8x8_ascii_next() */
+      for( ; *s != '\0' && *s != '\n'; s++ )
+      {
+        dx = glyph(x, y, ref_y, (uint8_t)*s);
+        x += dx;
+        sum += dx;
+      }
+      return sum;
+    }
+
+  private:
+    /* user coordinates to the upper left corner in the buffer of a w x h box */
+    static u8g2_uint_t bufX(u8g2_uint_t x, u8g2_uint_t w) { return rotation == U8G2_FIXED_R0 ? x : width - x - w; }
+    static u8g2_uint_t bufY(u8g2_uint_t y, u8g2_uint_t h) { return rotation == U8G2_FIXED_R0 ? y : height - y - h; }
+
+    /* 1 if the box is inside the clip window, so that no pixel must be clipped */
+    bool inside(int x, int y, int w, int h) const
+    {
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+      if ( u8g2.is_page_clip_window_intersection == 0 )
+        return false;
+#endif /* U8G2_WITH_CLIP_WINDOW_SUPPORT */
+      return x >= u8g2.user_x0 && x + w <= u8g2.user_x1 && y >= u8g2.user_y0 && y + h <= u8g2.user_y1;
+    }
+
+    /* same as u8g2_ll_hvline_vertical_top_lsb() for all pages of a box in buffer coordinates */
+    void fill(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+    {
+      uint8_t *ptr;
+      uint8_t mask;
+      uint8_t bit_pos = y & 7;
+      u8g2_uint_t i;
+
+      if ( w == 0 || h == 0 )
+        return;
+      ptr = u8g2.tile_buf_ptr + (y >> 3) * width + x;
+      for(;;)
+      {
+        mask = 0x0ff << bit_pos;
+        if ( h < 8 - bit_pos )
+        {
+          mask &= 0x0ff >> (8 - bit_pos - h);
+          h = 0;
+        }
+        else
+        {
+          h -= 8 - bit_pos;
+        }
+        if ( u8g2.draw_color == 1 )
+          for( i = 0; i < w; i++ )
+            ptr[i] |= mask;
+        else if ( u8g2.draw_color == 0 )
+          for( i = 0; i < w; i++ )
+            ptr[i] &= ~mask;
+        else
+          for( i = 0; i < w; i++ )
+            ptr[i] ^= mask;
+        if ( h == 0 )
+          break;
+        ptr += width;
+        bit_pos = 0;
+      }
+    }
+
+    bool isDirectFont(void) const
+    {
+      if ( rotation != U8G2_FIXED_R0 )
+        return false;
+#ifdef U8G2_WITH_FONT_ROTATION
+      if ( u8g2.font_decode.dir != 0 )
+        return false;
+#endif
+#ifdef U8G2_WITH_GLYPH_CACHE
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    /* y: argument of drawGlyph(), ref_y: y of the glyph reference point */
+    u8g2_uint_t glyph(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t ref_y, uint16_t encoding)
+    {
+#ifdef U8G2_WITH_GLYPH_CACHE
+      const u8g2_glyph_bitmap_t *g = u8g2_GetCachedGlyph(&u8g2, encoding);
+      int gx, gy;
+      if ( g != NULL )
+      {
+        if ( g->width == 0 )
+          return g->dx;
+        gx = x + g->x;
+        gy = ref_y - (g->height + g->y);
+        if ( gx >= 0 && gy >= 0 && inside(gx, gy, g->width, g->height) )
+        {
+          uint8_t *dest = u8g2.tile_buf_ptr + (gy >> 3) * width + gx;
+          uint8_t shift = gy & 7;
+          uint8_t solid = u8g2.font_decode.is_transparent == 0;
+          if ( u8g2.draw_color == 1 )
+            solid ? blit<1, true>(dest, g, shift) : blit<1, false>(dest, g, shift);
+          else if ( u8g2.draw_color == 0 )
+            solid ? blit<0, true>(dest, g, shift) : blit<0, false>(dest, g, shift);
+          else
+            solid ? blit<2, true>(dest, g, shift) : blit<2, false>(dest, g, shift);
+          return g->dx;
+        }
+      }
+#endif /* U8G2_WITH_GLYPH_CACHE */
+      return U8G2::drawGlyph(x, y, encoding);
+    }
+
+#ifdef U8G2_WITH_GLYPH_CACHE
+    /*
+      Combine the glyph with the buffer like u8g2_glyph_cache_blit(), but for
+      a glyph inside the clip window, with the color and font mode fixed:
+      buffer page p gets glyph page p shifted down by shift rows and the
+      bottom rows of glyph page p-1.
+    */
+    template <uint8_t color, bool solid>
+    static void blit(uint8_t *dest, const u8g2_glyph_bitmap_t *g, uint8_t shift)
+    {
+      const uint8_t w = g->width;
+      const uint8_t pages = (g->height + 7) >> 3;
+      const uint8_t last_rows = 0x0ff >> (pages * 8 - g->height);
+      const uint8_t dest_pages = (shift + g->height + 7) >> 3;
+      const uint8_t *src;
+      uint8_t p, c, f, m, rows, prev_rows;
+
+      prev_rows = 0;
+      for( p = 0; p < dest_pages; p++ )
+      {
+        src = g->bitmap + p * w;
+        rows = p < pages ? (p == pages - 1 ? last_rows : 0x0ff) : 0;
+        m = (uint8_t)(rows << shift) | (prev_rows >> (8 - shift));
+        for( c = 0; c < w; c++ )
+        {
+          f = 0;
+          if ( p < pages )
+            f = src[c] << shift;
+          if ( p > 0 )
+            f |= src[c - w] >> (8 - shift);
+
+          /* same as foreground and background runs in u8g2_font_decode_len() */
+          if ( color == 0 )
+          {
+            dest[c] &= ~f;
+            if ( solid )
+              dest[c] |= m & ~f;
+          }
+          else
+          {
+            if ( color == 1 )
+              dest[c] |= f;
+            else
+              dest[c] ^= f;
+            if ( solid )
+              dest[c] &= ~(m & ~f);
+          }
+        }
+        prev_rows = rows;
+        dest += width;
+      }
+    }
+#endif /* U8G2_WITH_GLYPH_CACHE */
+};
+
+#endif /* U8G2FIXED_HH */
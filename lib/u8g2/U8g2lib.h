@@ -134,6 +134,13 @@ class U8G2
 
     void setContrast(uint8_t value) {
       u8g2_SetContrast(&u8g2, value); }
+
+#ifdef U8X8_WITH_START_LINE
+    void setStartLine(uint8_t line) {
+      u8g2_SetStartLine(&u8g2, line); }
+    uint8_t getStartLine(void) { return u8g2_GetStartLine(&u8g2); }
+    uint8_t getRingRow(uint8_t row) { return u8g2_GetRingRow(&u8g2, row); }
+#endif
       
     void setDisplayRotation(const u8g2_cb_t *u8g2_cb) {
       u8g2_SetDisplayRotation(&u8g2, u8g2_cb); }
@@ -209,6 +216,20 @@ class U8G2
       { u8g2_UpdateDisplayArea(&u8g2, tx, ty, tw, th); }
     void updateDisplay(void)
       { u8g2_UpdateDisplay(&u8g2); }
+    uint16_t updateDisplayDiff(uint8_t *shadow)
+      { return u8g2_UpdateDisplayDiff(&u8g2, shadow); }
+    uint8_t updateDisplayDiffStep(uint8_t *shadow, uint16_t max_tiles)
+      { return u8g2_UpdateDisplayDiffStep(&u8g2, shadow, max_tiles); }
+    uint16_t queueUpdate(u8g2_tile_queue_t *queue)
+      { return u8g2_QueueUpdate(&u8g2, queue); }
+    uint16_t queueAll(u8g2_tile_queue_t *queue)
+      { return u8g2_QueueAll(&u8g2, queue); }
+    uint8_t queueStep(u8g2_tile_queue_t *queue, uint8_t max_tiles)
+      { return u8g2_QueueStep(&u8g2, queue, max_tiles); }
+#ifdef U8X8_WITH_START_LINE
+    void queueStartLine(u8g2_tile_queue_t *queue, uint8_t line)
+      { u8g2_QueueStartLine(&u8g2, queue, line); }
+#endif
     void refreshDisplay(void)
       { u8x8_RefreshDisplay(u8g2_GetU8x8(&u8g2)); }
     
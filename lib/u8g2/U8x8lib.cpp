@@ -1329,6 +1329,15 @@ extern "C" uint8_t u8x8_byte_arduino_sw_i2c(U8X8_UNUSED u8x8_t *u8x8, U8X8_UNUSE
 /*=============================================*/
 /*=== HARDWARE I2C ===*/
 
+/* bytes which Wire.write() takes between beginTransmission() and endTransmission() */
+#if defined(I2C_BUFFER_LENGTH)
+#define U8X8_WIRE_BUFFER_LENGTH (I2C_BUFFER_LENGTH < 255 ? I2C_BUFFER_LENGTH : 255)
+#elif defined(BUFFER_LENGTH)
+#define U8X8_WIRE_BUFFER_LENGTH (BUFFER_LENGTH < 255 ? BUFFER_LENGTH : 255)
+#else
+#define U8X8_WIRE_BUFFER_LENGTH 32
+#endif
+
 extern "C" uint8_t u8x8_byte_arduino_hw_i2c(U8X8_UNUSED u8x8_t *u8x8, U8X8_UNUSED uint8_t msg, U8X8_UNUSED uint8_t arg_int, U8X8_UNUSED void *arg_ptr)
 {
 #ifdef U8X8_HAVE_HW_I2C
@@ -1340,6 +1349,7 @@ extern "C" uint8_t u8x8_byte_arduino_hw_i2c(U8X8_UNUSED u8x8_t *u8x8, U8X8_UNUSE
     case U8X8_MSG_BYTE_INIT:
       if ( u8x8->bus_clock == 0 ) 	/* issue 769 */
 	u8x8->bus_clock = u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+      u8x8->i2c_max_transfer = U8X8_WIRE_BUFFER_LENGTH;
 #if defined(ESP8266) || defined(ARDUINO_ARCH_ESP8266) || defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
       /* for ESP8266/ESP32, Wire.begin has two more arguments: clock and data */          
       if ( u8x8->pins[U8X8_PIN_I2C_CLOCK] != U8X8_PIN_NONE && u8x8->pins[U8X8_PIN_I2C_DATA] != U8X8_PIN_NONE )
@@ -1389,6 +1399,7 @@ extern "C" uint8_t u8x8_byte_arduino_2nd_hw_i2c(U8X8_UNUSED u8x8_t *u8x8, U8X8_U
     case U8X8_MSG_BYTE_INIT:
       if ( u8x8->bus_clock == 0 ) 	/* issue 769 */
 	u8x8->bus_clock = u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+      u8x8->i2c_max_transfer = U8X8_WIRE_BUFFER_LENGTH;
       Wire1.begin();
       break;
     case U8X8_MSG_BYTE_SET_DC:
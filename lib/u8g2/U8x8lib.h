@@ -280,6 +280,15 @@ class U8X8
     void setContrast(uint8_t value) {
       u8x8_SetContrast(&u8x8, value); }
 
+#ifdef U8X8_WITH_START_LINE
+    void setStartLine(uint8_t line) {
+      u8x8_SetStartLine(&u8x8, line); }
+    uint8_t getStartLine(void) { return u8x8_GetStartLine(&u8x8); }
+    uint8_t getRingRow(uint8_t row) { return u8x8_GetRingRow(&u8x8, row); }
+    void drawRingTile(uint8_t x, uint8_t row, uint8_t cnt, uint8_t *tile_ptr) {
+      u8x8_DrawRingTile(&u8x8, x, row, cnt, tile_ptr); }
+#endif
+
     void setInverseFont(uint8_t value) {
       u8x8_SetInverseFont(&u8x8, value); }
 
@@ -301,6 +310,9 @@ class U8X8
     void drawUTF8(uint8_t x, uint8_t y, const char *s) {
       u8x8_DrawUTF8(&u8x8, x, y, s); }
 
+    uint8_t drawStringDiff(uint8_t x, uint8_t y, const char *s, char *prev) {
+      return u8x8_DrawStringDiff(&u8x8, x, y, s, prev); }
+
     void draw2x2String(uint8_t x, uint8_t y, const char *s) {
       u8x8_Draw2x2String(&u8x8, x, y, s); }
 
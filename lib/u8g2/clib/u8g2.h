@@ -175,6 +175,45 @@
 #define U8G2_BALANCED_STR_WIDTH_CALCULATION
 #endif
 
+/*
+  The following macro enables a RAM index for the glyphs 0..255 of a font.
+  Without the index, each glyph lookup walks the glyph list of the font, starting
+  at the first glyph, 'A' or 'a'. With the index, u8g2_SetFont() walks the glyph
+  list once and each lookup is a single table access.
+  Indices are kept for the last U8G2_GLYPH_INDEX_FONTS fonts, so that switching
+  between these fonts does not rebuild the index. Each index requires 512 bytes
+  RAM and a font pointer (about 2 KB for 4 fonts), so the index is not enabled
+  by default: define U8G2_WITH_GLYPH_INDEX for all files, e.g. in the build
+  flags. The option changes u8g2_t.
+*/
+//#define U8G2_WITH_GLYPH_INDEX
+
+#ifndef U8G2_GLYPH_INDEX_FONTS
+#define U8G2_GLYPH_INDEX_FONTS 4
+#endif
+
+/*
+  The following macro enables a cache for decoded glyphs, see u8g2_glyph_cache.c.
+  A cached glyph is stored in the vertical byte format of the display buffer and
+  is copied into the buffer with byte operations, instead of decoding the glyph and
+  drawing each run as a line. The cache is used for U8G2_R0 and displays with
+  the u8g2_ll_hvline_vertical_top_lsb buffer format.
+  The least recently used glyph is replaced if all U8G2_GLYPH_CACHE_ENTRIES are in use.
+  Glyphs with up to 32 pixel height and width*(height+7)/8 <= U8G2_GLYPH_CACHE_SLOT_SIZE
+  are cached. The cache requires U8G2_GLYPH_CACHE_ENTRIES*(U8G2_GLYPH_CACHE_SLOT_SIZE+16)
+  bytes RAM (3200 bytes with the defaults), so it is not enabled by default:
+  define U8G2_WITH_GLYPH_CACHE for all files, e.g. in the build flags.
+*/
+//#define U8G2_WITH_GLYPH_CACHE
+
+#ifndef U8G2_GLYPH_CACHE_ENTRIES
+#define U8G2_GLYPH_CACHE_ENTRIES 40
+#endif
+
+#ifndef U8G2_GLYPH_CACHE_SLOT_SIZE
+#define U8G2_GLYPH_CACHE_SLOT_SIZE 64
+#endif
+
 
 /*==========================================*/
 
@@ -280,6 +319,9 @@ struct _u8g2_font_decode_t
   int8_t glyph_height;
 
   uint8_t decode_bit_pos;			/* bitpos inside a byte of the compressed data */
+#ifdef U8X8_WITH_FONT_WORD_READ
+  u8x8_font_word_t decode_word;		/* word of decode_ptr or the word before */
+#endif
   uint8_t is_transparent;
   uint8_t fg_color;
   uint8_t bg_color;
@@ -289,6 +331,45 @@ struct _u8g2_font_decode_t
 };
 typedef struct _u8g2_font_decode_t u8g2_font_decode_t;
 
+#ifdef U8G2_WITH_GLYPH_INDEX
+#define U8G2_GLYPH_INDEX_NONE 0x0ffff
+
+struct _u8g2_glyph_index_t
+{
+  const uint8_t *font;		/* font of this index, NULL if unused */
+  uint16_t offset[256];		/* glyph position behind the font header or U8G2_GLYPH_INDEX_NONE */
+};
+typedef struct _u8g2_glyph_index_t u8g2_glyph_index_t;
+#endif /* U8G2_WITH_GLYPH_INDEX */
+
+/* tiles queued for transfer, see u8g2_QueueUpdate() */
+struct _u8g2_tile_queue_t
+{
+  uint8_t *shadow;		/* display content after all queued tiles are sent, size of the buffer */
+  uint8_t *dirty;		/* one bit per tile of the display: queued, not yet sent */
+  uint16_t next;		/* tile (row major) where the next step starts */
+  uint16_t pending;		/* number of queued tiles */
+#ifdef U8X8_WITH_START_LINE
+  uint8_t start_line;		/* display start line after all queued tiles are sent */
+  uint8_t is_start_line_queued;	/* start_line is sent after the queued tiles */
+#endif
+};
+typedef struct _u8g2_tile_queue_t u8g2_tile_queue_t;
+
+#ifdef U8G2_WITH_GLYPH_CACHE
+/* glyph in the vertical byte format of the buffer, see u8g2_GetCachedGlyph() */
+struct _u8g2_glyph_bitmap_t
+{
+  int8_t x;			/* glyph offset and delta x as in the font */
+  int8_t y;
+  int8_t dx;
+  uint8_t width;
+  uint8_t height;
+  uint8_t bitmap[U8G2_GLYPH_CACHE_SLOT_SIZE];	/* (height+7)/8 pages with width bytes each */
+};
+typedef struct _u8g2_glyph_bitmap_t u8g2_glyph_bitmap_t;
+#endif /* U8G2_WITH_GLYPH_CACHE */
+
 struct _u8g2_kerning_t
 {
   uint16_t first_table_cnt;
@@ -363,6 +444,9 @@ struct u8g2_struct
   u8g2_font_calc_vref_fnptr font_calc_vref;
   u8g2_font_decode_t font_decode;		/* new font decode structure */
   u8g2_font_info_t font_info;			/* new font info structure */
+#ifdef U8G2_WITH_GLYPH_INDEX
+  const u8g2_glyph_index_t *glyph_index;	/* index of the current font, set by u8g2_SetFont */
+#endif /* U8G2_WITH_GLYPH_INDEX */
 
 #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
   /* 1 of there is an intersection between user_?? and clip_?? box */
@@ -407,6 +491,11 @@ struct u8g2_struct
 #define u8g2_SetPowerSave(u8g2, is_enable) u8x8_SetPowerSave(u8g2_GetU8x8(u8g2), (is_enable))
 #define u8g2_SetFlipMode(u8g2, mode) u8x8_SetFlipMode(u8g2_GetU8x8(u8g2), (mode))
 #define u8g2_SetContrast(u8g2, value) u8x8_SetContrast(u8g2_GetU8x8(u8g2), (value))
+#ifdef U8X8_WITH_START_LINE
+#define u8g2_SetStartLine(u8g2, line) u8x8_SetStartLine(u8g2_GetU8x8(u8g2), (line))
+#define u8g2_GetStartLine(u8g2) u8x8_GetStartLine(u8g2_GetU8x8(u8g2))
+#define u8g2_GetRingRow(u8g2, row) u8x8_GetRingRow(u8g2_GetU8x8(u8g2), (row))
+#endif
 //#define u8g2_ClearDisplay(u8g2) u8x8_ClearDisplay(u8g2_GetU8x8(u8g2))  obsolete, can not be used in all cases
 void u8g2_ClearDisplay(u8g2_t *u8g2);
 
@@ -1730,6 +1819,19 @@ uint8_t u8g2_NextPage(u8g2_t *u8g2);
 
 void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th);
 void u8g2_UpdateDisplay(u8g2_t *u8g2);
+uint16_t u8g2_UpdateDisplayDiff(u8g2_t *u8g2, uint8_t *shadow);
+uint8_t u8g2_UpdateDisplayDiffStep(u8g2_t *u8g2, uint8_t *shadow, uint16_t max_tiles);
+void u8g2_InitTileQueue(u8g2_tile_queue_t *queue, uint8_t *shadow, uint8_t *dirty);
+uint16_t u8g2_QueueUpdate(u8g2_t *u8g2, u8g2_tile_queue_t *queue);
+uint16_t u8g2_QueueAll(u8g2_t *u8g2, u8g2_tile_queue_t *queue);
+uint8_t u8g2_QueueStep(u8g2_t *u8g2, u8g2_tile_queue_t *queue, uint8_t max_tiles);
+#ifdef U8X8_WITH_START_LINE
+void u8g2_QueueStartLine(u8g2_t *u8g2, u8g2_tile_queue_t *queue, uint8_t line);
+#define u8g2_GetQueueStartLine(queue) ((queue)->start_line)
+#define u8g2_IsTileQueueEmpty(queue) ((queue)->pending == 0 && (queue)->is_start_line_queued == 0)
+#else
+#define u8g2_IsTileQueueEmpty(queue) ((queue)->pending == 0)
+#endif
 
 void u8g2_WriteBufferPBM(u8g2_t *u8g2, void (*out)(const char *s));
 void u8g2_WriteBufferXBM(u8g2_t *u8g2, void (*out)(const char *s));
@@ -1751,6 +1853,9 @@ void u8g2_WriteBufferXBM2(u8g2_t *u8g2, void (*out)(const char *s));
 
 /* SSD13xx, UC17xx, UC16xx */
 void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+#ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+void u8g2_ll_box_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+#endif
 /* ST7920 */
 void u8g2_ll_hvline_horizontal_right_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
 
@@ -1760,6 +1865,9 @@ void u8g2_ll_hvline_horizontal_right_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_
 
 /* u8g2_DrawHVLine does not use u8g2_IsIntersection */
 void u8g2_DrawHVLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+#ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+uint8_t u8g2_draw_box_fast(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+#endif
 
 /* the following three function will do an intersection test of this is enabled with U8G2_WITH_INTERSECTION */
 void u8g2_DrawHLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len);
@@ -1862,6 +1970,18 @@ uint8_t u8g2_GetKerning(u8g2_t *u8g2, u8g2_kerning_t *kerning, uint16_t e1, uint
 uint8_t u8g2_GetKerningByTable(u8g2_t *u8g2, const uint16_t *kt, uint16_t e1, uint16_t e2);
 
 
+/*==========================================*/
+/* u8g2_glyph_cache.c */
+#ifdef U8G2_WITH_GLYPH_CACHE
+uint8_t u8g2_glyph_cache_draw(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding, u8g2_uint_t *dx);
+const u8g2_glyph_bitmap_t *u8g2_GetCachedGlyph(u8g2_t *u8g2, uint16_t encoding);
+void u8g2_ClearGlyphCache(void);
+void u8g2_ClearGlyphCacheStats(void);
+uint32_t u8g2_GetGlyphCacheHits(void);
+uint32_t u8g2_GetGlyphCacheMisses(void);
+#endif /* U8G2_WITH_GLYPH_CACHE */
+
+
 /*==========================================*/
 /* u8g2_font.c */
 
@@ -1878,6 +1998,9 @@ size_t u8g2_GetFontSize(const uint8_t *font_arg);
 void u8g2_SetFont(u8g2_t *u8g2, const uint8_t  *font);
 void u8g2_SetFontMode(u8g2_t *u8g2, uint8_t is_transparent);
 
+uint8_t u8g2_font_decode_get_unsigned_bits(u8g2_font_decode_t *f, uint8_t cnt);
+int8_t u8g2_font_decode_get_signed_bits(u8g2_font_decode_t *f, uint8_t cnt);
+const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding);
 uint8_t u8g2_IsGlyph(u8g2_t *u8g2, uint16_t requested_encoding);
 int8_t u8g2_GetGlyphWidth(u8g2_t *u8g2, uint16_t requested_encoding);
 
@@ -174,6 +174,260 @@ void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, u
   }  
 }
 
+/*
+  send at most max_tiles of those tiles, which differ between buffer and
+  shadow buffer, starting at the top left tile. Adjacent changed tiles within
+  a tile row are sent with one u8x8_DrawTile() call. Returns the number of
+  tiles sent.
+*/
+static uint16_t u8g2_send_diff(u8g2_t *u8g2, uint8_t *shadow, uint16_t max_tiles)
+{
+  uint8_t *ptr;
+  uint8_t tw;
+  uint8_t tx;
+  uint8_t ty;
+  uint8_t run_start;
+  uint16_t cnt = 0;
+  
+  tw = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  ptr = u8g2_GetBufferPtr(u8g2);
+  for( ty = 0; ty < u8g2->tile_buf_height; ty++ )
+  {
+    run_start = tw;	/* no run */
+    for( tx = 0; tx <= tw; tx++ )
+    {
+      if ( tx < tw && cnt + (tx-run_start) < max_tiles && memcmp(ptr+tx*8, shadow+tx*8, 8) != 0 )
+      {
+	if ( run_start == tw )
+	  run_start = tx;
+      }
+      else if ( run_start != tw )
+      {
+	memcpy(shadow+run_start*8, ptr+run_start*8, (tx-run_start)*8);
+	u8x8_DrawTile( u8g2_GetU8x8(u8g2), run_start, ty, tx-run_start, ptr+run_start*8 );
+	cnt += tx-run_start;
+	run_start = tw;
+      }
+      if ( cnt >= max_tiles )
+	return cnt;
+    }
+    ptr += tw*8;
+    shadow += tw*8;
+  }
+  return cnt;
+}
+
+/*
+  Description:
+    Send only those tiles of the buffer, which differ from the shadow buffer.
+    Adjacent changed tiles within a tile row are sent with one u8x8_DrawTile()
+    call. The shadow buffer is updated with the tiles which were sent.
+    The shadow buffer must have u8g2_GetBufferSize() bytes. It must contain
+    the current display content, e.g. a copy of the buffer after u8g2_SendBuffer().
+
+  Returns:
+    Number of tiles sent to the display.
+
+  Limitations:
+    Same as u8g2_UpdateDisplayArea()
+*/
+uint16_t u8g2_UpdateDisplayDiff(u8g2_t *u8g2, uint8_t *shadow)
+{
+  if ( u8g2->tile_buf_height != u8g2_GetU8x8(u8g2)->display_info->tile_height )
+    return 0; /* not in full buffer mode, do nothing */
+  return u8g2_send_diff(u8g2, shadow, 0xffff);
+}
+
+/*
+  Description:
+    Incremental version of u8g2_UpdateDisplayDiff(): Send at most max_tiles
+    of the changed tiles, so that other work (e.g. a sensor on the same
+    I2C bus) can be done between the calls. Call again until 0 is returned.
+    The buffer must not be modified until the transfer has finished.
+
+  Returns:
+    1 if there might be more tiles to send, 0 if the display is up to date.
+*/
+uint8_t u8g2_UpdateDisplayDiffStep(u8g2_t *u8g2, uint8_t *shadow, uint16_t max_tiles)
+{
+  if ( u8g2->tile_buf_height != u8g2_GetU8x8(u8g2)->display_info->tile_height )
+    return 0; /* not in full buffer mode, do nothing */
+  if ( max_tiles == 0 )
+    max_tiles = 1;
+  return u8g2_send_diff(u8g2, shadow, max_tiles) >= max_tiles;
+}
+
+/*
+  Description:
+    Prepare a queue for u8g2_QueueUpdate(). The shadow buffer must have
+    u8g2_GetBufferSize() bytes and contain the current display content.
+    dirty must have one bit per tile of the display (16 bytes for 128x64).
+    The queue is empty afterwards, the display start line is assumed to be 0.
+*/
+void u8g2_InitTileQueue(u8g2_tile_queue_t *queue, uint8_t *shadow, uint8_t *dirty)
+{
+  queue->shadow = shadow;
+  queue->dirty = dirty;
+  queue->next = 0;
+  queue->pending = 0;
+#ifdef U8X8_WITH_START_LINE
+  queue->start_line = 0;
+  queue->is_start_line_queued = 0;
+#endif
+}
+
+/*
+  Description:
+    Queue the transfer of the buffer: Tiles which differ from the shadow
+    buffer are copied to the shadow buffer and marked for u8g2_QueueStep().
+    The buffer can be redrawn right after this call. Tiles which are queued
+    again before they were sent, are only sent once with the latest content.
+    Nothing is sent to the display.
+
+  Returns:
+    Number of tiles which were not queued before.
+
+  Limitations:
+    Same as u8g2_UpdateDisplayArea()
+*/
+uint16_t u8g2_QueueUpdate(u8g2_t *u8g2, u8g2_tile_queue_t *queue)
+{
+  uint8_t *ptr;
+  uint8_t *shadow;
+  uint16_t tile;
+  uint16_t tiles;
+  uint16_t cnt = 0;
+  uint8_t mask;
+  
+  if ( u8g2->tile_buf_height != u8g2_GetU8x8(u8g2)->display_info->tile_height )
+    return 0; /* not in full buffer mode, do nothing */
+  
+  ptr = u8g2_GetBufferPtr(u8g2);
+  shadow = queue->shadow;
+  tiles = u8g2_GetU8x8(u8g2)->display_info->tile_width * u8g2->tile_buf_height;
+  for( tile = 0; tile < tiles; tile++ )
+  {
+    if ( memcmp(ptr, shadow, 8) != 0 )
+    {
+      memcpy(shadow, ptr, 8);
+      mask = 1 << (tile & 7);
+      if ( (queue->dirty[tile >> 3] & mask) == 0 )
+      {
+	queue->dirty[tile >> 3] |= mask;
+	cnt++;
+      }
+    }
+    ptr += 8;
+    shadow += 8;
+  }
+  queue->pending += cnt;
+  return cnt;
+}
+
+/*
+  Description:
+    Like u8g2_QueueUpdate(), but queue all tiles of the buffer, also those
+    equal to the shadow buffer. For when something else has written to the
+    display (e.g. u8x8 tile output), so that the shadow is no longer valid.
+
+  Returns:
+    Number of tiles which were not queued before.
+*/
+uint16_t u8g2_QueueAll(u8g2_t *u8g2, u8g2_tile_queue_t *queue)
+{
+  uint16_t tiles;
+  uint16_t cnt;
+  
+  if ( u8g2->tile_buf_height != u8g2_GetU8x8(u8g2)->display_info->tile_height )
+    return 0; /* not in full buffer mode, do nothing */
+  
+  tiles = u8g2_GetU8x8(u8g2)->display_info->tile_width * u8g2->tile_buf_height;
+  memcpy(queue->shadow, u8g2_GetBufferPtr(u8g2), tiles*8);
+  cnt = tiles - queue->pending;
+  memset(queue->dirty, 0xff, (tiles+7) >> 3);
+  queue->pending = tiles;
+  return cnt;
+}
+
+#ifdef U8X8_WITH_START_LINE
+/*
+  Description:
+    Queue a new display start line. u8g2_QueueStep() sends it once no more
+    tiles are queued, so that a row which scrolls into view is on the
+    display before it is shown. Draw the frame for the new start line,
+    then call u8g2_QueueUpdate(). u8g2_GetQueueStartLine() returns the
+    start line of the queued frame.
+*/
+void u8g2_QueueStartLine(u8g2_t *u8g2, u8g2_tile_queue_t *queue, uint8_t line)
+{
+  line %= u8g2_GetU8x8(u8g2)->display_info->pixel_height;
+  if ( line == queue->start_line )
+    return;
+  queue->start_line = line;
+  queue->is_start_line_queued = 1;
+}
+#endif
+
+/*
+  Description:
+    Send the next run of at most max_tiles queued tiles within one tile
+    row from the shadow buffer, with one u8x8_DrawTile() call. A frame is
+    sent in steps, so that the CPU can do other work (e.g. read a sensor)
+    between the steps. If max_tiles fits into one transfer of the
+    interface, each step is one bus transaction. A queued start line is
+    sent in a step of its own after the last tile.
+
+  Returns:
+    1 if more tiles or the start line are queued, 0 if the display is up
+    to date.
+*/
+uint8_t u8g2_QueueStep(u8g2_t *u8g2, u8g2_tile_queue_t *queue, uint8_t max_tiles)
+{
+  uint8_t tw;
+  uint16_t tiles;
+  uint16_t tile;
+  uint8_t cnt;
+  
+  if ( queue->pending == 0 )
+  {
+#ifdef U8X8_WITH_START_LINE
+    if ( queue->is_start_line_queued != 0 )
+    {
+      queue->is_start_line_queued = 0;
+      u8x8_SetStartLine(u8g2_GetU8x8(u8g2), queue->start_line);
+    }
+#endif
+    return 0;
+  }
+  if ( max_tiles == 0 )
+    max_tiles = 1;
+  tw = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  tiles = tw * u8g2->tile_buf_height;
+  
+  /* continue behind the last run, so that all rows get their turn */
+  tile = queue->next;
+  while( (queue->dirty[tile >> 3] & (1 << (tile & 7))) == 0 )
+  {
+    tile++;
+    if ( tile >= tiles )
+      tile = 0;
+  }
+  
+  cnt = 0;
+  do
+  {
+    queue->dirty[(tile+cnt) >> 3] &= ~(1 << ((tile+cnt) & 7));
+    cnt++;
+  } while( cnt < max_tiles && (tile+cnt) % tw != 0 && (queue->dirty[(tile+cnt) >> 3] & (1 << ((tile+cnt) & 7))) != 0 );
+  
+  u8x8_DrawTile(u8g2_GetU8x8(u8g2), tile % tw, tile / tw, cnt, queue->shadow + tile*8);
+  queue->pending -= cnt;
+  queue->next = tile + cnt;
+  if ( queue->next >= tiles )
+    queue->next = 0;
+  return !u8g2_IsTileQueueEmpty(queue);
+}
+
 /* same as sendBuffer, but does not send the ePaper refresh message */
 void u8g2_UpdateDisplay(u8g2_t *u8g2)
 {
@@ -108,21 +108,22 @@ void u8g2_font_GetStrMinBox(u8g2_t *u8g2, const void *font, const char *s, u8g2_
 
 /* removed NOINLINE, because it leads to smaller code, might also be faster */
 //static uint8_t u8g2_font_get_byte(const uint8_t *font, uint8_t offset) U8G2_NOINLINE;
-static uint8_t u8g2_font_get_byte(const uint8_t *font, uint8_t offset)
+/* w: the last word read, see u8x8_font_read() */
+static uint8_t u8g2_font_get_byte(u8x8_font_word_t *w, const uint8_t *font, uint8_t offset)
 {
   font += offset;
-  return u8x8_pgm_read( font );  
+  return u8x8_font_read( w, font );  
 }
 
-static uint16_t u8g2_font_get_word(const uint8_t *font, uint8_t offset) U8G2_NOINLINE; 
-static uint16_t u8g2_font_get_word(const uint8_t *font, uint8_t offset)
+static uint16_t u8g2_font_get_word(u8x8_font_word_t *w, const uint8_t *font, uint8_t offset) U8G2_NOINLINE; 
+static uint16_t u8g2_font_get_word(u8x8_font_word_t *w, const uint8_t *font, uint8_t offset)
 {
     uint16_t pos;
     font += offset;
-    pos = u8x8_pgm_read( font );
+    pos = u8x8_font_read( w, font );
     font++;
     pos <<= 8;
-    pos += u8x8_pgm_read( font);
+    pos += u8x8_font_read( w, font );
     return pos;
 }
 
@@ -130,38 +131,41 @@ static uint16_t u8g2_font_get_word(const uint8_t *font, uint8_t offset)
 /* new font format */
 void u8g2_read_font_info(u8g2_font_info_t *font_info, const uint8_t *font)
 {
+  u8x8_font_word_t w;
+  u8x8_font_word_init(&w);
+  
   /* offset 0 */
-  font_info->glyph_cnt = u8g2_font_get_byte(font, 0);
-  font_info->bbx_mode = u8g2_font_get_byte(font, 1);
-  font_info->bits_per_0 = u8g2_font_get_byte(font, 2);
-  font_info->bits_per_1 = u8g2_font_get_byte(font, 3);
+  font_info->glyph_cnt = u8g2_font_get_byte(&w, font, 0);
+  font_info->bbx_mode = u8g2_font_get_byte(&w, font, 1);
+  font_info->bits_per_0 = u8g2_font_get_byte(&w, font, 2);
+  font_info->bits_per_1 = u8g2_font_get_byte(&w, font, 3);
   
   /* offset 4 */
-  font_info->bits_per_char_width = u8g2_font_get_byte(font, 4);
-  font_info->bits_per_char_height = u8g2_font_get_byte(font, 5);
-  font_info->bits_per_char_x = u8g2_font_get_byte(font, 6);
-  font_info->bits_per_char_y = u8g2_font_get_byte(font, 7);
-  font_info->bits_per_delta_x = u8g2_font_get_byte(font, 8);
+  font_info->bits_per_char_width = u8g2_font_get_byte(&w, font, 4);
+  font_info->bits_per_char_height = u8g2_font_get_byte(&w, font, 5);
+  font_info->bits_per_char_x = u8g2_font_get_byte(&w, font, 6);
+  font_info->bits_per_char_y = u8g2_font_get_byte(&w, font, 7);
+  font_info->bits_per_delta_x = u8g2_font_get_byte(&w, font, 8);
   
   /* offset 9 */
-  font_info->max_char_width = u8g2_font_get_byte(font, 9);
-  font_info->max_char_height = u8g2_font_get_byte(font, 10);
-  font_info->x_offset = u8g2_font_get_byte(font, 11);
-  font_info->y_offset = u8g2_font_get_byte(font, 12);
+  font_info->max_char_width = u8g2_font_get_byte(&w, font, 9);
+  font_info->max_char_height = u8g2_font_get_byte(&w, font, 10);
+  font_info->x_offset = u8g2_font_get_byte(&w, font, 11);
+  font_info->y_offset = u8g2_font_get_byte(&w, font, 12);
   
   /* offset 13 */
-  font_info->ascent_A = u8g2_font_get_byte(font, 13);
-  font_info->descent_g = u8g2_font_get_byte(font, 14);
-  font_info->ascent_para = u8g2_font_get_byte(font, 15);
-  font_info->descent_para = u8g2_font_get_byte(font, 16);
+  font_info->ascent_A = u8g2_font_get_byte(&w, font, 13);
+  font_info->descent_g = u8g2_font_get_byte(&w, font, 14);
+  font_info->ascent_para = u8g2_font_get_byte(&w, font, 15);
+  font_info->descent_para = u8g2_font_get_byte(&w, font, 16);
   
   /* offset 17 */
-  font_info->start_pos_upper_A = u8g2_font_get_word(font, 17);
-  font_info->start_pos_lower_a = u8g2_font_get_word(font, 19); 
+  font_info->start_pos_upper_A = u8g2_font_get_word(&w, font, 17);
+  font_info->start_pos_lower_a = u8g2_font_get_word(&w, font, 19); 
   
   /* offset 21 */
 #ifdef U8G2_WITH_UNICODE
-  font_info->start_pos_unicode = u8g2_font_get_word(font, 21); 
+  font_info->start_pos_unicode = u8g2_font_get_word(&w, font, 21); 
 #endif
 }
 
@@ -171,29 +175,31 @@ size_t u8g2_GetFontSize(const uint8_t *font_arg)
 {
   uint16_t e;
   const uint8_t *font = font_arg;
+  u8x8_font_word_t w;
+  u8x8_font_word_init(&w);
   font += U8G2_FONT_DATA_STRUCT_SIZE;
   
   for(;;)
   {
-    if ( u8x8_pgm_read( font + 1 ) == 0 )
+    if ( u8x8_font_read( &w, font + 1 ) == 0 )
       break;
-    font += u8x8_pgm_read( font + 1 );
+    font += u8x8_font_read( &w, font + 1 );
   }
   
   /* continue with unicode section */
   font += 2;
 
   /* skip unicode lookup table */
-  font += u8g2_font_get_word(font, 0);
+  font += u8g2_font_get_word(&w, font, 0);
   
   for(;;)
   {
-    e = u8x8_pgm_read( font );
+    e = u8x8_font_read( &w, font );
     e <<= 8;
-    e |= u8x8_pgm_read( font + 1 );
+    e |= u8x8_font_read( &w, font + 1 );
     if ( e == 0 )
       break;
-    font += u8x8_pgm_read( font + 2 );    
+    font += u8x8_font_read( &w, font + 2 );    
   }
   
   return (font - font_arg) + 2;
@@ -233,6 +239,29 @@ uint8_t u8g2_GetFontCapitalAHeight(u8g2_t *u8g2)
 /*========================================================================*/
 /* glyph handling */
 
+#ifdef U8X8_WITH_FONT_WORD_READ
+/*
+  Description:
+    The next cnt bits, taken from the word of decode_ptr, and from the
+    following word if they continue there. Each word is loaded once.
+*/
+uint8_t u8g2_font_decode_get_unsigned_bits(u8g2_font_decode_t *f, uint8_t cnt) 
+{
+  const uint32_t *a = (const uint32_t *)((uintptr_t)f->decode_ptr & ~(uintptr_t)3);
+  uint8_t bit_pos = f->decode_bit_pos;
+  uint8_t offset = (((uintptr_t)f->decode_ptr & 3) << 3) + bit_pos;
+  uint32_t val;
+  
+  val = u8x8_font_get_word(&(f->decode_word), a) >> offset;
+  if ( offset + cnt > 32 )
+    val |= u8x8_font_get_word(&(f->decode_word), a + 1) << (32 - offset);
+  
+  bit_pos += cnt;
+  f->decode_ptr += bit_pos >> 3;
+  f->decode_bit_pos = bit_pos & 7;
+  return val & ((1U<<cnt)-1);
+}
+#else
 /* optimized */
 uint8_t u8g2_font_decode_get_unsigned_bits(u8g2_font_decode_t *f, uint8_t cnt) 
 {
@@ -262,6 +291,7 @@ uint8_t u8g2_font_decode_get_unsigned_bits(u8g2_font_decode_t *f, uint8_t cnt)
   f->decode_bit_pos = bit_pos_plus_cnt;
   return val;
 }
+#endif /* U8X8_WITH_FONT_WORD_READ */
 
 
 /*
@@ -575,11 +605,109 @@ void u8g2_font_2x_decode_len(u8g2_t *u8g2, uint8_t len, uint8_t is_foreground)
 }
 
 
+#ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+/*
+  Description:
+    Same as u8g2_font_decode_len(), but writes the pixel directly into a
+    u8g2_ll_hvline_vertical_top_lsb buffer without clipping. Only used for
+    glyphs which are completely inside the user window, see u8g2_font_is_direct().
+*/
+static void u8g2_font_decode_len_direct(u8g2_t *u8g2, uint8_t len, uint8_t is_foreground)
+{
+  uint8_t cnt;
+  uint8_t rem;
+  uint8_t current;
+  uint8_t lx,ly;
+  uint8_t color, mask, i;
+  u8g2_uint_t y;
+  uint8_t *ptr;
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  
+  cnt = len;
+  lx = decode->x;
+  ly = decode->y;
+  color = is_foreground ? decode->fg_color : decode->bg_color;
+  
+  for(;;)
+  {
+    rem = decode->glyph_width;
+    rem -= lx;
+    current = rem;
+    if ( cnt < rem )
+      current = cnt;
+    
+    if ( is_foreground || decode->is_transparent == 0 )
+    {
+      y = decode->target_y;
+      y += ly;
+      y -= u8g2->pixel_curr_row;
+      ptr = u8g2->tile_buf_ptr;
+      ptr += (uint16_t)(y >> 3) * u8g2->pixel_buf_width;
+      ptr += decode->target_x;
+      ptr += lx;
+      mask = 1 << (y & 7);
+      for( i = 0; i < current; i++ )
+      {
+	if ( color <= 1 )
+	  ptr[i] |= mask;
+	if ( color != 1 )
+	  ptr[i] ^= mask;
+      }
+    }
+    
+    if ( cnt < rem )
+      break;
+    cnt -= rem;
+    lx = 0;
+    ly++;
+  }
+  lx += cnt;
+  
+  decode->x = lx;
+  decode->y = ly;  
+}
+
+/*
+  Description:
+    Check whether a glyph at the current decode target can be drawn with
+    u8g2_font_decode_len_direct(): rotation R0 for display and font, vertical_top_lsb
+    buffer and the glyph box is completely inside the user window.
+*/
+static uint8_t u8g2_font_is_direct(u8g2_t *u8g2, int8_t h)
+{
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  u8g2_uint_t x1, y1;
+  
+  if ( u8g2->cb != U8G2_R0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb )
+    return 0;
+#ifdef U8G2_WITH_FONT_ROTATION
+  if ( decode->dir != 0 )
+    return 0;
+#endif
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if ( u8g2->is_page_clip_window_intersection == 0 )
+    return 0;
+#endif /* U8G2_WITH_CLIP_WINDOW_SUPPORT */
+  x1 = decode->target_x;
+  x1 += decode->glyph_width;
+  y1 = decode->target_y;
+  y1 += h;
+  if ( decode->target_x < u8g2->user_x0 || x1 < decode->target_x || x1 > u8g2->user_x1 )
+    return 0;
+  if ( decode->target_y < u8g2->user_y0 || y1 < decode->target_y || y1 > u8g2->user_y1 )
+    return 0;
+  return 1;
+}
+#endif /* U8G2_WITH_HVLINE_SPEED_OPTIMIZATION */
+
 static void u8g2_font_setup_decode(u8g2_t *u8g2, const uint8_t *glyph_data)
 {
   u8g2_font_decode_t *decode = &(u8g2->font_decode);
   decode->decode_ptr = glyph_data;
   decode->decode_bit_pos = 0;
+#ifdef U8X8_WITH_FONT_WORD_READ
+  u8x8_font_word_init(&(decode->decode_word));
+#endif
   
   /* 8 Nov 2015, this is already done in the glyph data search procedure */
   /*
@@ -616,6 +744,7 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
   int8_t d;
   int8_t h;
   u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  void (*decode_len)(u8g2_t *u8g2, uint8_t len, uint8_t is_foreground) = u8g2_font_decode_len;
     
   u8g2_font_setup_decode(u8g2, glyph_data);     /* set values in u8g2->font_decode data structure */
   h = u8g2->font_decode.glyph_height;
@@ -684,6 +813,12 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
     }
 #endif /* U8G2_WITH_INTERSECTION */
    
+#ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+    /* glyphs which are completely visible skip clipping */
+    if ( u8g2_font_is_direct(u8g2, h) )
+      decode_len = u8g2_font_decode_len_direct;
+#endif /* U8G2_WITH_HVLINE_SPEED_OPTIMIZATION */
+   
     /* reset local x/y position */
     decode->x = 0;
     decode->y = 0;
@@ -695,8 +830,8 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
       b = u8g2_font_decode_get_unsigned_bits(decode, u8g2->font_info.bits_per_1);
       do
       {
-	u8g2_font_decode_len(u8g2, a, 0);
-	u8g2_font_decode_len(u8g2, b, 1);
+	decode_len(u8g2, a, 0);
+	decode_len(u8g2, b, 1);
       } while( u8g2_font_decode_get_unsigned_bits(decode, 1) != 0 );
 
       if ( decode->y >= h )
@@ -771,6 +906,56 @@ int8_t u8g2_font_2x_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
   return d*2;
 }
 
+#ifdef U8G2_WITH_GLYPH_INDEX
+static u8g2_glyph_index_t u8g2_glyph_index_list[U8G2_GLYPH_INDEX_FONTS];
+static uint8_t u8g2_glyph_index_next;
+
+/*
+  Description:
+    Return the glyph index of a font. The index is built on first use by walking
+    the glyph list of the font once. If all indices are in use, the oldest index
+    is replaced. Indices are shared by all u8g2 objects.
+  Args:
+    font: Font data
+  Return:
+    Index of the font.
+*/
+static const u8g2_glyph_index_t *u8g2_get_glyph_index(const uint8_t *font)
+{
+  u8g2_glyph_index_t *idx;
+  const uint8_t *glyph;
+  uint16_t i;
+  uint8_t size;
+  u8x8_font_word_t w;
+  
+  for( i = 0; i < U8G2_GLYPH_INDEX_FONTS; i++ )
+  {
+    if ( u8g2_glyph_index_list[i].font == font )
+      return u8g2_glyph_index_list+i;
+  }
+  
+  idx = u8g2_glyph_index_list + u8g2_glyph_index_next;
+  u8g2_glyph_index_next++;
+  if ( u8g2_glyph_index_next >= U8G2_GLYPH_INDEX_FONTS )
+    u8g2_glyph_index_next = 0;
+  
+  idx->font = font;
+  for( i = 0; i < 256; i++ )
+    idx->offset[i] = U8G2_GLYPH_INDEX_NONE;
+  glyph = font + U8G2_FONT_DATA_STRUCT_SIZE;
+  u8x8_font_word_init(&w);
+  for(;;)
+  {
+    size = u8x8_font_read( &w, glyph + 1 );
+    if ( size == 0 )
+      break;
+    idx->offset[u8x8_font_read( &w, glyph )] = glyph - font - U8G2_FONT_DATA_STRUCT_SIZE;
+    glyph += size;
+  }
+  return idx;
+}
+#endif /* U8G2_WITH_GLYPH_INDEX */
+
 /*
   Description:
     Find the starting point of the glyph data.
@@ -782,11 +967,23 @@ int8_t u8g2_font_2x_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
 const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
 {
   const uint8_t *font = u8g2->font;
+  u8x8_font_word_t w;
+  u8x8_font_word_init(&w);
   font += U8G2_FONT_DATA_STRUCT_SIZE;
 
   
   if ( encoding <= 255 )
   {
+#ifdef U8G2_WITH_GLYPH_INDEX
+    /* the index may have been replaced by another u8g2 object, then walk the list */
+    if ( u8g2->glyph_index != NULL && u8g2->glyph_index->font == u8g2->font )
+    {
+      uint16_t offset = u8g2->glyph_index->offset[encoding];
+      if ( offset == U8G2_GLYPH_INDEX_NONE )
+	return NULL;
+      return font+offset+2;	/* skip encoding and glyph size */
+    }
+#endif /* U8G2_WITH_GLYPH_INDEX */
     if ( encoding >= 'a' )
     {
       font += u8g2->font_info.start_pos_lower_a;
@@ -798,13 +995,14 @@ const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
     
     for(;;)
     {
-      if ( u8x8_pgm_read( font + 1 ) == 0 )
+      uint8_t size = u8x8_font_read( &w, font + 1 );
+      if ( size == 0 )
 	break;
-      if ( u8x8_pgm_read( font ) == encoding )
+      if ( u8x8_font_read( &w, font ) == encoding )
       {
 	return font+2;	/* skip encoding and glyph size */
       }
-      font += u8x8_pgm_read( font + 1 );
+      font += size;
     }
   }
 #ifdef U8G2_WITH_UNICODE
@@ -828,17 +1026,17 @@ const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
     /* issue 596: search for the glyph start in the unicode lookup table */
     do
     {
-      font += u8g2_font_get_word(unicode_lookup_table, 0);
-      e = u8g2_font_get_word(unicode_lookup_table, 2);
+      font += u8g2_font_get_word(&w, unicode_lookup_table, 0);
+      e = u8g2_font_get_word(&w, unicode_lookup_table, 2);
       unicode_lookup_table+=4;
     } while( e < encoding );
     
   
     for(;;)
     {
-      e = u8x8_pgm_read( font );
+      e = u8x8_font_read( &w, font );
       e <<= 8;
-      e |= u8x8_pgm_read( font + 1 );
+      e |= u8x8_font_read( &w, font + 1 );
   
 // removed, there is now the new index table  
 //#ifdef  __unix__
@@ -858,7 +1056,7 @@ const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
 //#endif 
 	return font+3;	/* skip encoding and glyph size */
       }
-      font += u8x8_pgm_read( font + 2 );
+      font += u8x8_font_read( &w, font + 2 );
     }  
   }
 #endif
@@ -869,11 +1067,16 @@ const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
 static u8g2_uint_t u8g2_font_draw_glyph(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding)
 {
   u8g2_uint_t dx = 0;
+  const uint8_t *glyph_data;
+#ifdef U8G2_WITH_GLYPH_CACHE
+  if ( u8g2_glyph_cache_draw(u8g2, x, y, encoding, &dx) != 0 )
+    return dx;
+#endif /* U8G2_WITH_GLYPH_CACHE */
   u8g2->font_decode.target_x = x;
   u8g2->font_decode.target_y = y;
   //u8g2->font_decode.is_transparent = is_transparent; this is already set
   //u8g2->font_decode.dir = dir;
-  const uint8_t *glyph_data = u8g2_font_get_glyph_data(u8g2, encoding);
+  glyph_data = u8g2_font_get_glyph_data(u8g2, encoding);
   if ( glyph_data != NULL )
   {
     dx = u8g2_font_decode_glyph(u8g2, glyph_data);
@@ -1286,6 +1489,9 @@ void u8g2_SetFont(u8g2_t *u8g2, const uint8_t  *font)
 //#endif 
     u8g2->font = font;
     u8g2_read_font_info(&(u8g2->font_info), font);
+#ifdef U8G2_WITH_GLYPH_INDEX
+    u8g2->glyph_index = u8g2_get_glyph_index(font);
+#endif
     u8g2_UpdateRefHeight(u8g2);
     /* u8g2_SetFontPosBaseline(u8g2); */ /* removed with issue 195 */
   }
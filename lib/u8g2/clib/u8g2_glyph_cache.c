@@ -0,0 +1,379 @@
+/*
+
+  u8g2_glyph_cache.c
+
+  Universal 8bit Graphics Library (https://github.com/olikraus/u8g2/)
+
+  Copyright (c) 2016, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, 
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list 
+    of conditions and the following disclaimer.
+    
+  * Redistributions in binary form must reproduce the above copyright notice, this 
+    list of conditions and the following disclaimer in the documentation and/or other 
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND 
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  
+
+  Cache for decoded glyphs.
+
+  A glyph is decoded once into the vertical byte format of the display buffer
+  (u8g2_ll_hvline_vertical_top_lsb): byte bitmap[page*width+column] contains
+  the pixel rows page*8 .. page*8+7 of the column, LSB is the top row.
+  Drawing a cached glyph combines these bytes with the display buffer, shifted
+  to the target row, instead of decoding the run length code and drawing
+  each run with u8g2_DrawHVLine().
+
+  The cache is shared by all u8g2 objects. Entries are identified by font
+  and encoding, the least recently used entry is replaced.
+
+*/
+
+#include "u8g2.h"
+#include <string.h>
+
+#ifdef U8G2_WITH_GLYPH_CACHE
+
+struct _u8g2_glyph_cache_entry_t
+{
+  const uint8_t *font;		/* font of the glyph, NULL if unused */
+  uint16_t encoding;
+  uint16_t last_use;		/* value of u8g2_glyph_cache_time at the last use */
+  u8g2_glyph_bitmap_t glyph;
+};
+typedef struct _u8g2_glyph_cache_entry_t u8g2_glyph_cache_entry_t;
+
+static u8g2_glyph_cache_entry_t u8g2_glyph_cache[U8G2_GLYPH_CACHE_ENTRIES];
+static uint16_t u8g2_glyph_cache_time;
+static uint32_t u8g2_glyph_cache_hits;
+static uint32_t u8g2_glyph_cache_misses;
+
+/*
+  Description:
+    Set the next len pixel of the glyph, same walk as u8g2_font_decode_len().
+*/
+static void u8g2_glyph_cache_decode_len(u8g2_glyph_bitmap_t *e, u8g2_font_decode_t *decode, uint8_t len, uint8_t is_foreground)
+{
+  uint8_t cnt = len;
+  uint8_t rem, current, i, mask;
+  uint8_t lx = decode->x;
+  uint8_t ly = decode->y;
+  uint8_t *p;
+  
+  for(;;)
+  {
+    rem = e->width;
+    rem -= lx;
+    current = rem;
+    if ( cnt < rem )
+      current = cnt;
+    
+    if ( is_foreground && ly < e->height )
+    {
+      p = e->bitmap + (ly >> 3) * e->width + lx;
+      mask = 1 << (ly & 7);
+      for( i = 0; i < current; i++ )
+	p[i] |= mask;
+    }
+    
+    if ( cnt < rem )
+      break;
+    cnt -= rem;
+    lx = 0;
+    ly++;
+  }
+  lx += cnt;
+  
+  decode->x = lx;
+  decode->y = ly;
+}
+
+/*
+  Description:
+    Decode a glyph of the current font into the bitmap of a cache entry.
+  Return:
+    0, if the glyph is too large for the cache.
+*/
+static uint8_t u8g2_glyph_cache_fill(u8g2_t *u8g2, u8g2_glyph_bitmap_t *e, const uint8_t *glyph_data)
+{
+  u8g2_font_decode_t decode;
+  uint8_t a, b, w, h;
+  
+  decode.decode_ptr = glyph_data;
+  decode.decode_bit_pos = 0;
+#ifdef U8X8_WITH_FONT_WORD_READ
+  u8x8_font_word_init(&decode.decode_word);
+#endif
+  w = u8g2_font_decode_get_unsigned_bits(&decode, u8g2->font_info.bits_per_char_width);
+  h = u8g2_font_decode_get_unsigned_bits(&decode, u8g2->font_info.bits_per_char_height);
+  if ( h > 32 || (uint16_t)w * ((h + 7) >> 3) > U8G2_GLYPH_CACHE_SLOT_SIZE )
+    return 0;
+  
+  e->width = w;
+  e->height = h;
+  e->x = u8g2_font_decode_get_signed_bits(&decode, u8g2->font_info.bits_per_char_x);
+  e->y = u8g2_font_decode_get_signed_bits(&decode, u8g2->font_info.bits_per_char_y);
+  e->dx = u8g2_font_decode_get_signed_bits(&decode, u8g2->font_info.bits_per_delta_x);
+  memset(e->bitmap, 0, w * ((h + 7) >> 3));
+  
+  if ( w > 0 )
+  {
+    decode.x = 0;
+    decode.y = 0;
+    for(;;)
+    {
+      a = u8g2_font_decode_get_unsigned_bits(&decode, u8g2->font_info.bits_per_0);
+      b = u8g2_font_decode_get_unsigned_bits(&decode, u8g2->font_info.bits_per_1);
+      do
+      {
+	u8g2_glyph_cache_decode_len(e, &decode, a, 0);
+	u8g2_glyph_cache_decode_len(e, &decode, b, 1);
+      } while( u8g2_font_decode_get_unsigned_bits(&decode, 1) != 0 );
+      
+      if ( decode.y >= h )
+	break;
+    }
+  }
+  return 1;
+}
+
+/*
+  Description:
+    Combine a cached glyph with the display buffer.
+    Pixel outside of the user window (current page and clip window) are not changed,
+    the result is the same as with u8g2_font_decode_glyph().
+  Args:
+    x, y: upper left corner of the glyph bitmap
+*/
+static void u8g2_glyph_cache_blit(u8g2_t *u8g2, const u8g2_glyph_bitmap_t *e, u8g2_uint_t x, u8g2_uint_t y)
+{
+  uint32_t rows, fg, col;
+  uint8_t *dest;
+  uint8_t r, r0, r1, c, p, page0, page1, f, m;
+  u8g2_uint_t xx, yy;
+  int16_t row0;		/* buffer row of the glyph row 0 */
+  int8_t s;
+  uint8_t color = u8g2->draw_color;
+  uint8_t is_solid = u8g2->font_decode.is_transparent == 0;
+  
+  /* visible glyph rows, these are always a single range */
+  rows = 0;
+  r0 = 0;
+  r1 = 0;
+  for( r = 0; r < e->height; r++ )
+  {
+    yy = y;
+    yy += r;
+    if ( yy >= u8g2->user_y0 && yy < u8g2->user_y1 )
+    {
+      if ( rows == 0 )
+	r0 = r;
+      r1 = r;
+      rows |= (uint32_t)1 << r;
+    }
+  }
+  if ( rows == 0 )
+    return;
+  
+  yy = y;
+  yy += r0;
+  row0 = (int16_t)(u8g2_uint_t)(yy - u8g2->pixel_curr_row) - r0;
+  page0 = (row0 + r0) >> 3;
+  page1 = (row0 + r1) >> 3;
+  
+  for( c = 0; c < e->width; c++ )
+  {
+    xx = x;
+    xx += c;
+    if ( xx < u8g2->user_x0 || xx >= u8g2->user_x1 )
+      continue;
+    
+    col = 0;
+    for( p = 0; p < ((e->height + 7) >> 3); p++ )
+      col |= (uint32_t)e->bitmap[p * e->width + c] << (p * 8);
+    fg = col & rows;
+    
+    dest = u8g2->tile_buf_ptr + (uint16_t)page0 * u8g2->pixel_buf_width + xx;
+    for( p = page0; p <= page1; p++ )
+    {
+      /* glyph row at the top of this page */
+      s = p * 8 - row0;
+      if ( s >= 0 )
+      {
+	f = fg >> s;
+	m = rows >> s;
+      }
+      else
+      {
+	f = fg << -s;
+	m = rows << -s;
+      }
+      
+      /* same as foreground and background runs in u8g2_font_decode_len() */
+      if ( color == 0 )
+      {
+	*dest &= ~f;
+	if ( is_solid )
+	  *dest |= m & ~f;
+      }
+      else 
+      {
+	if ( color == 1 )
+	  *dest |= f;
+	else
+	  *dest ^= f;
+	if ( is_solid )
+	  *dest &= ~(m & ~f);
+      }
+      dest += u8g2->pixel_buf_width;
+    }
+  }
+}
+
+/*
+  Description:
+    Find a glyph of the current font in the cache, decode it into the cache
+    first if required.
+  Return:
+    NULL, if the glyph does not exist or is too large for the cache.
+*/
+static u8g2_glyph_cache_entry_t *u8g2_glyph_cache_get(u8g2_t *u8g2, uint16_t encoding)
+{
+  u8g2_glyph_cache_entry_t *e;
+  u8g2_glyph_cache_entry_t *victim;
+  const uint8_t *glyph_data;
+  uint8_t i;
+  
+  e = NULL;
+  victim = u8g2_glyph_cache;
+  for( i = 0; i < U8G2_GLYPH_CACHE_ENTRIES; i++ )
+  {
+    if ( u8g2_glyph_cache[i].font == u8g2->font && u8g2_glyph_cache[i].encoding == encoding )
+    {
+      e = u8g2_glyph_cache+i;
+      break;
+    }
+    if ( victim->font != NULL )
+    {
+      if ( u8g2_glyph_cache[i].font == NULL || 
+	  (uint16_t)(u8g2_glyph_cache_time - u8g2_glyph_cache[i].last_use) > (uint16_t)(u8g2_glyph_cache_time - victim->last_use) )
+	victim = u8g2_glyph_cache+i;
+    }
+  }
+  
+  if ( e == NULL )
+  {
+    glyph_data = u8g2_font_get_glyph_data(u8g2, encoding);
+    if ( glyph_data == NULL )
+      return NULL;
+    if ( u8g2_glyph_cache_fill(u8g2, &(victim->glyph), glyph_data) == 0 )
+      return NULL;
+    victim->font = u8g2->font;
+    victim->encoding = encoding;
+    e = victim;
+    u8g2_glyph_cache_misses++;
+  }
+  else
+  {
+    u8g2_glyph_cache_hits++;
+  }
+  
+  u8g2_glyph_cache_time++;
+  e->last_use = u8g2_glyph_cache_time;
+  return e;
+}
+
+/*
+  Description:
+    Draw a glyph from the cache, decode it into the cache first if required.
+    Called by u8g2_font_draw_glyph().
+  Args:
+    x, y: reference point of the glyph, same as for u8g2_font_decode_glyph()
+    dx: receives the delta x advance of the glyph
+  Return:
+    0, if the glyph can not be drawn from the cache. The caller must draw the
+    glyph with u8g2_font_decode_glyph().
+*/
+uint8_t u8g2_glyph_cache_draw(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding, u8g2_uint_t *dx)
+{
+  u8g2_glyph_cache_entry_t *e;
+  
+  if ( u8g2->cb != U8G2_R0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb )
+    return 0;
+#ifdef U8G2_WITH_FONT_ROTATION
+  if ( u8g2->font_decode.dir != 0 )
+    return 0;
+#endif
+  
+  e = u8g2_glyph_cache_get(u8g2, encoding);
+  if ( e == NULL )
+    return 0;
+  
+  if ( e->glyph.width > 0 )
+  {
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+    if ( u8g2->is_page_clip_window_intersection != 0 )
+#endif /* U8G2_WITH_CLIP_WINDOW_SUPPORT */
+      u8g2_glyph_cache_blit(u8g2, &(e->glyph), x + e->glyph.x, y - (e->glyph.height + e->glyph.y));
+  }
+  *dx = e->glyph.dx;
+  return 1;
+}
+
+/*
+  Description:
+    Get a glyph of the current font in the vertical byte format of the
+    buffer, for a renderer which writes into the buffer itself (U8g2Fixed.h).
+    The glyph box starts at x + glyph->x and y - (glyph->height + glyph->y)
+    for the reference point x, y of u8g2_DrawGlyph().
+    The glyph is valid until the next call of a glyph cache procedure.
+  Return:
+    NULL, if the glyph does not exist or is too large for the cache.
+*/
+const u8g2_glyph_bitmap_t *u8g2_GetCachedGlyph(u8g2_t *u8g2, uint16_t encoding)
+{
+  u8g2_glyph_cache_entry_t *e = u8g2_glyph_cache_get(u8g2, encoding);
+  if ( e == NULL )
+    return NULL;
+  return &(e->glyph);
+}
+
+/* remove all glyphs, required if font data in RAM is changed */
+void u8g2_ClearGlyphCache(void)
+{
+  memset(u8g2_glyph_cache, 0, sizeof(u8g2_glyph_cache));
+}
+
+void u8g2_ClearGlyphCacheStats(void)
+{
+  u8g2_glyph_cache_hits = 0;
+  u8g2_glyph_cache_misses = 0;
+}
+
+uint32_t u8g2_GetGlyphCacheHits(void)
+{
+  return u8g2_glyph_cache_hits;
+}
+
+uint32_t u8g2_GetGlyphCacheMisses(void)
+{
+  return u8g2_glyph_cache_misses;
+}
+
+#endif /* U8G2_WITH_GLYPH_CACHE */
@@ -141,6 +141,33 @@ void u8g2_draw_hv_line_2dir(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uin
 }
 
 
+#ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
+/*
+  Draw a box with the page fill procedure of the buffer, if there is one for
+  the buffer format and rotation. Clipping is the same as for the lines of the
+  box in u8g2_DrawHVLine().
+  Returns 0 if the box must be drawn line by line.
+*/
+uint8_t u8g2_draw_box_fast(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  if ( u8g2->cb != U8G2_R0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb )
+    return 0;
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if ( u8g2->is_page_clip_window_intersection == 0 )
+    return 1;
+#endif /* U8G2_WITH_CLIP_WINDOW_SUPPORT */
+  if ( w == 0 || h == 0 )
+    return 1;
+  if ( u8g2_clip_intersection2(&x, &w, u8g2->user_x0, u8g2->user_x1) == 0 )
+    return 1;
+  if ( u8g2_clip_intersection2(&y, &h, u8g2->user_y0, u8g2->user_y1) == 0 )
+    return 1;
+  y -= u8g2->pixel_curr_row;
+  u8g2_ll_box_vertical_top_lsb(u8g2, x, y, w, h);
+  return 1;
+}
+#endif /* U8G2_WITH_HVLINE_SPEED_OPTIMIZATION */
+
 /*
   This is the toplevel function for the hv line draw procedures.
   This function should be called by the user.
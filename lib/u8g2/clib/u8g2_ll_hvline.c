@@ -61,6 +61,49 @@
 
 #ifdef U8G2_WITH_HVLINE_SPEED_OPTIMIZATION
 
+#ifdef __GNUC__
+/* 32 bit access to the byte buffer, may_alias keeps this valid for the optimizer */
+typedef uint32_t __attribute__((__may_alias__)) u8g2_ll_word_t;
+#define U8G2_LL_WITH_WORD_ACCESS
+#endif
+
+/*
+  Apply or_mask and xor_mask to len consecutive bytes.
+  Long runs are processed with aligned 32 bit words.
+*/
+static void u8g2_ll_fill_bytes(uint8_t *ptr, u8g2_uint_t len, uint8_t or_mask, uint8_t xor_mask)
+{
+#ifdef U8G2_LL_WITH_WORD_ACCESS
+  if ( len >= 8 )
+  {
+    uint32_t or_word, xor_word;
+    
+    while( ((uintptr_t)ptr & 3) != 0 )
+    {
+      *ptr |= or_mask;
+      *ptr ^= xor_mask;
+      ptr++;
+      len--;
+    }
+    or_word = or_mask * 0x01010101UL;
+    xor_word = xor_mask * 0x01010101UL;
+    do
+    {
+      *(u8g2_ll_word_t *)ptr = (*(u8g2_ll_word_t *)ptr | or_word) ^ xor_word;
+      ptr += 4;
+      len -= 4;
+    } while( len >= 4 );
+  }
+#endif /* U8G2_LL_WITH_WORD_ACCESS */
+  while( len != 0 )
+  {
+    *ptr |= or_mask;
+    *ptr ^= xor_mask;
+    ptr++;
+    len--;
+  }
+}
+
 /*
   x,y		Upper left position of the line within the local buffer (not the display!)
   len		length of the line in pixel, len must not be 0
@@ -87,16 +130,6 @@ void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
   /* bytes are vertical, lsb on top (y=0), msb at bottom (y=7) */
   bit_pos = y;		/* overflow truncate is ok here... */
   bit_pos &= 7; 	/* ... because only the lowest 3 bits are needed */
-  mask = 1;
-  mask <<= bit_pos;
-
-  or_mask = 0;
-  xor_mask = 0;
-  if ( u8g2->draw_color <= 1 )
-    or_mask  = mask;
-  if ( u8g2->draw_color != 1 )
-    xor_mask = mask;
-
 
   offset = y;		/* y might be 8 or 16 bit, but we need 16 bit, so use a 16 bit variable */
   offset &= ~7;
@@ -107,51 +140,111 @@ void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
   
   if ( dir == 0 )
   {
-      do
-      {
+    mask = 1;
+    mask <<= bit_pos;
+    or_mask = 0;
+    xor_mask = 0;
+    if ( u8g2->draw_color <= 1 )
+      or_mask  = mask;
+    if ( u8g2->draw_color != 1 )
+      xor_mask = mask;
 #ifdef __unix
-	assert(ptr < max_ptr);
+    assert(ptr + len <= max_ptr);
 #endif
-	*ptr |= or_mask;
-	*ptr ^= xor_mask;
-	ptr++;
-	len--;
-      } while( len != 0 );
+    u8g2_ll_fill_bytes(ptr, len, or_mask, xor_mask);
   }
   else
   {    
-    do
+    /* all pixel of the line within one page are set at once */
+    for(;;)
     {
 #ifdef __unix
       assert(ptr < max_ptr);
 #endif
-      *ptr |= or_mask;
-      *ptr ^= xor_mask;
-      
-      bit_pos++;
-      bit_pos &= 7;
-
-      len--;
-
-      if ( bit_pos == 0 )
+      mask = 0x0ff;
+      mask <<= bit_pos;
+      if ( len < 8 - bit_pos )
       {
-	ptr+=u8g2->pixel_buf_width;	/* 6 Jan 17: Changed u8g2->width to u8g2->pixel_buf_width, issue #148 */
-		
-	if ( u8g2->draw_color <= 1 )
-	  or_mask  = 1;
-	if ( u8g2->draw_color != 1 )
-	  xor_mask = 1;
+	mask &= 0x0ff >> (8 - bit_pos - len);
+	len = 0;
       }
       else
       {
-	or_mask <<= 1;
-	xor_mask <<= 1;
+	len -= 8 - bit_pos;
       }
-    } while( len != 0 );
+      
+      if ( u8g2->draw_color <= 1 )
+	*ptr |= mask;
+      if ( u8g2->draw_color != 1 )
+	*ptr ^= mask;
+      
+      if ( len == 0 )
+	break;
+      ptr+=u8g2->pixel_buf_width;	/* 6 Jan 17: Changed u8g2->width to u8g2->pixel_buf_width, issue #148 */
+      bit_pos = 0;
+    }
   }
 }
 
+/*
+  x,y		Upper left position of the box within the local buffer (not the display!)
+  w,h		size of the box, w and h must not be 0
+  Fills the box page by page: the rows of the box within a page are
+  set with a single mask for all bytes of the page.
+  asumption: 
+    all clipping done
+*/
+void u8g2_ll_box_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  uint16_t offset;
+  uint8_t *ptr;
+  uint8_t bit_pos, mask;
+  uint8_t or_mask, xor_mask;
+#ifdef __unix
+  uint8_t *max_ptr = u8g2->tile_buf_ptr + u8g2_GetU8x8(u8g2)->display_info->tile_width*u8g2->tile_buf_height*8;
+#endif
+
+  bit_pos = y;
+  bit_pos &= 7;
 
+  offset = y;
+  offset &= ~7;
+  offset *= u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  ptr = u8g2->tile_buf_ptr;
+  ptr += offset;
+  ptr += x;
+  
+  for(;;)
+  {
+#ifdef __unix
+    assert(ptr + w <= max_ptr);
+#endif
+    mask = 0x0ff;
+    mask <<= bit_pos;
+    if ( h < 8 - bit_pos )
+    {
+      mask &= 0x0ff >> (8 - bit_pos - h);
+      h = 0;
+    }
+    else
+    {
+      h -= 8 - bit_pos;
+    }
+    
+    or_mask = 0;
+    xor_mask = 0;
+    if ( u8g2->draw_color <= 1 )
+      or_mask  = mask;
+    if ( u8g2->draw_color != 1 )
+      xor_mask = mask;
+    u8g2_ll_fill_bytes(ptr, w, or_mask, xor_mask);
+    
+    if ( h == 0 )
+      break;
+    ptr+=u8g2->pixel_buf_width;
+    bit_pos = 0;
+  }
+}
 
 #else /* U8G2_WITH_HVLINE_SPEED_OPTIMIZATION */
 
@@ -93,6 +93,15 @@
 #define U8X8_WITH_SET_CONTRAST
 #endif
 
+/*
+  Define U8X8_WITH_START_LINE for u8x8_SetStartLine() and the ring addressed
+  tile rows (u8x8_DrawRingTile(), u8x8_GetRingRow()). The SH1106/SSD1306 tile
+  draw then keeps the start line instead of resetting it to 0. The option
+  changes u8x8_t, so it is not enabled by default: define it for all files,
+  e.g. in the build flags.
+*/
+//#define U8X8_WITH_START_LINE
+
 /* Define this for an additional user pointer inside the u8x8 data struct */
 //#define U8X8_WITH_USER_PTR
 
@@ -164,6 +173,29 @@ uint8_t u8x8_pgm_read_esp(const uint8_t * addr);   /* u8x8_8x8.c */
 #  define U8X8_PROGMEM
 #endif
 
+/*
+  Host builds with U8X8_FONT_WORD_READ_EMULATION read U8X8_PROGMEM data like
+  the ESP8266: only with aligned 32 bit loads, see u8x8_font_load_word().
+*/
+#if defined(U8X8_FONT_WORD_READ_EMULATION) && !defined(ESP8266)
+#  if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#    error "U8X8_FONT_WORD_READ_EMULATION requires a little endian host"
+#  endif
+uint8_t u8x8_pgm_read_esp(const uint8_t * addr);   /* u8x8_8x8.c */
+#  define u8x8_pgm_read(adr) u8x8_pgm_read_esp(adr)
+#endif
+
+/*
+  Word-wise font reads: u8x8_pgm_read_esp() does a 32 bit load for every byte.
+  With U8X8_WITH_FONT_WORD_READ, fonts are read through u8x8_font_read(),
+  which keeps the last loaded word in a u8x8_font_word_t, and the u8g2 glyph
+  decoder takes its bit fields from that word. U8X8_NO_FONT_WORD_READ keeps
+  the byte reads.
+*/
+#if (defined(ESP8266) || defined(U8X8_FONT_WORD_READ_EMULATION)) && !defined(U8X8_NO_FONT_WORD_READ)
+#  define U8X8_WITH_FONT_WORD_READ
+#endif
+
 
 
 #ifndef U8X8_FONT_SECTION
@@ -186,6 +218,46 @@ uint8_t u8x8_pgm_read_esp(const uint8_t * addr);   /* u8x8_8x8.c */
 #  define U8X8_PROGMEM
 #endif
 
+/* the last aligned word loaded from font data */
+typedef struct u8x8_font_word_struct u8x8_font_word_t;
+struct u8x8_font_word_struct
+{
+  const uint32_t *addr;		/* NULL: nothing loaded */
+  uint32_t word;
+};
+
+#define u8x8_font_word_init(w) ((w)->addr = NULL, (w)->word = 0)
+
+#ifdef U8X8_FONT_WORD_READ_EMULATION
+/* aborts on a misaligned address, counts the loads */
+uint32_t u8x8_font_load_word(const uint32_t *addr);	/* u8x8_8x8.c */
+extern unsigned long u8x8_font_word_loads;
+#else
+#  define u8x8_font_load_word(addr) (*(addr))
+#endif
+
+#ifdef U8X8_WITH_FONT_WORD_READ
+/* the word at the aligned address a, loaded only if it is not the last one */
+static inline uint32_t u8x8_font_get_word(u8x8_font_word_t *w, const uint32_t *a)
+{
+  if ( w->addr != a )
+  {
+    w->word = u8x8_font_load_word(a);
+    w->addr = a;
+  }
+  return w->word;
+}
+
+/* the font byte at adr (little endian words) */
+static inline uint8_t u8x8_font_read(u8x8_font_word_t *w, const uint8_t *adr)
+{
+  const uint32_t *a = (const uint32_t *)((uintptr_t)adr & ~(uintptr_t)3);
+  return u8x8_font_get_word(w, a) >> (((uintptr_t)adr & 3) << 3);
+}
+#else
+#  define u8x8_font_read(w, adr) ((void)(w), u8x8_pgm_read(adr))
+#endif
+
 #ifdef ARDUINO
 #define U8X8_USE_PINS
 #endif
@@ -351,11 +423,15 @@ struct u8x8_struct
   const uint8_t *font;
   uint16_t encoding;		/* encoding result for utf8 decoder in next_cb */
   uint8_t x_offset;	/* copied from info struct, can be modified in flip mode */
+#ifdef U8X8_WITH_START_LINE
+  uint8_t start_line;	/* display start line, 0 if not supported by the display */
+#endif
   uint8_t is_font_inverse_mode; 	/* 0: normal, 1: font glyphs are inverted */
   uint8_t i2c_address;	/* a valid i2c adr. Initially this is 255, but this is set to something useful during DISPLAY_INIT */
 					/* i2c_address is the address for writing data to the display */
 					/* usually, the lowest bit must be zero for a valid address */
   uint8_t i2c_started;	/* for i2c interface */
+  uint8_t i2c_max_transfer;	/* bytes per i2c transfer which the byte procedure can take, 0: unknown */
   //uint8_t device_address;	/* OBSOLETE???? - this is the device address, replacement for U8X8_MSG_CAD_SET_DEVICE */
   uint8_t utf8_state;		/* number of chars which are still to scan */
   uint8_t gpio_result;	/* return value from the gpio call (only for MENU keys at the moment) */ 
@@ -533,6 +609,18 @@ void u8x8_d_helper_display_init(u8x8_t *u8g2);
 */
 #define U8X8_MSG_DISPLAY_REFRESH 16
 
+/*
+  Name: 	U8X8_MSG_DISPLAY_SET_START_LINE
+  Args:	arg_int: first RAM line which is shown in the top row of the display
+  Tasks:
+    Reprograms the display start line, so that the display shows the RAM
+    rotated by arg_int lines (hardware vertical scrolling). Stores the value
+    in u8x8->start_line.
+    Displays which do not support this, ignore the message, start_line stays 0.
+    This message is only sent if U8X8_WITH_START_LINE is defined.
+*/
+#define U8X8_MSG_DISPLAY_SET_START_LINE 17
+
 /*==========================================*/
 /* u8x8_setup.c */
 
@@ -585,6 +673,20 @@ void u8x8_FillDisplay(u8x8_t *u8x8);
 void u8x8_RefreshDisplay(u8x8_t *u8x8);	// make RAM content visible on the display (Dec 16: SSD1606 only)
 void u8x8_ClearLine(u8x8_t *u8x8, uint8_t line);
 
+#ifdef U8X8_WITH_START_LINE
+/* 
+  Hardware scrolling: The display shows the RAM starting at the start line
+  and wraps around at the end of the RAM. With a start line, which is a
+  multiple of 8, the tile rows of the RAM form a ring: Tile row "row" of the
+  screen is at RAM tile row u8x8_GetRingRow(). A scrolling screen only writes
+  the row which became free and moves the start line by 8.
+*/
+void u8x8_SetStartLine(u8x8_t *u8x8, uint8_t line);
+#define u8x8_GetStartLine(u8x8) ((u8x8)->start_line)
+#define u8x8_GetRingRow(u8x8, row) ((uint8_t)(((row) + ((u8x8)->start_line >> 3)) % (u8x8)->display_info->tile_height))
+void u8x8_DrawRingTile(u8x8_t *u8x8, uint8_t x, uint8_t row, uint8_t cnt, uint8_t *tile_ptr);
+#endif
+
 
 
 /*==========================================*/
@@ -665,6 +767,7 @@ uint8_t u8x8_cad_100(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_st7920_spi(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_ssd13xx_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_ssd13xx_fast_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+uint8_t u8x8_cad_sh1106_fast_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_st75256_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_ld7032_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_cad_uc16xx_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);  /* CAD=001 */
@@ -1075,6 +1178,7 @@ void u8x8_Draw2x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
 void u8x8_Draw1x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
 uint8_t u8x8_DrawString(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_DrawUTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);	/* return number of glyps */
+uint8_t u8x8_DrawStringDiff(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s, char *prev);
 uint8_t u8x8_Draw2x2String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_Draw2x2UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_Draw1x2String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
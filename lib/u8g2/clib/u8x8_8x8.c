@@ -41,9 +41,33 @@
 uint8_t u8x8_pgm_read_esp(const uint8_t * addr) 
 {
     uint32_t bytes;
-    bytes = *(uint32_t*)((uint32_t)addr & ~3);
+    bytes = u8x8_font_load_word((const uint32_t *)((uint32_t)addr & ~3));
     return ((uint8_t*)&bytes)[(uint32_t)addr & 3];
 }
+#elif defined(U8X8_FONT_WORD_READ_EMULATION)
+uint8_t u8x8_pgm_read_esp(const uint8_t * addr) 
+{
+    uint32_t bytes;
+    bytes = u8x8_font_load_word((const uint32_t *)((uintptr_t)addr & ~(uintptr_t)3));
+    return ((uint8_t*)&bytes)[(uintptr_t)addr & 3];
+}
+#endif
+
+#ifdef U8X8_FONT_WORD_READ_EMULATION
+#include <stdlib.h>
+#include <string.h>
+
+unsigned long u8x8_font_word_loads;
+
+uint32_t u8x8_font_load_word(const uint32_t *addr)
+{
+  uint32_t word;
+  if ( ((uintptr_t)addr & 3) != 0 )
+    abort();	/* the ESP8266 raises an exception */
+  u8x8_font_word_loads++;
+  memcpy(&word, addr, 4);
+  return word;
+}
 #endif
 
 
@@ -63,10 +87,12 @@ void u8x8_get_glyph_data(u8x8_t *u8x8, uint8_t encoding, uint8_t *buf, uint8_t t
 {
   uint8_t first, last, tiles, i;
   uint16_t offset;
-  first = u8x8_pgm_read(u8x8->font+0);
-  last = u8x8_pgm_read(u8x8->font+1);
-  tiles = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
-  tiles *= u8x8_pgm_read(u8x8->font+3);	/* new 2019 format */
+  u8x8_font_word_t w;
+  u8x8_font_word_init(&w);
+  first = u8x8_font_read(&w, u8x8->font+0);
+  last = u8x8_font_read(&w, u8x8->font+1);
+  tiles = u8x8_font_read(&w, u8x8->font+2);		/* new 2019 format */
+  tiles *= u8x8_font_read(&w, u8x8->font+3);	/* new 2019 format */
   
   /* get the glyph bitmap from the font */
   if ( first <= encoding && encoding <= last )
@@ -79,7 +105,7 @@ void u8x8_get_glyph_data(u8x8_t *u8x8, uint8_t encoding, uint8_t *buf, uint8_t t
     offset +=4;			/* changed from 2 to 4, new 2019 format */
     for( i = 0; i < 8; i++ )
     {
-      buf[i] = u8x8_pgm_read(u8x8->font+offset);
+      buf[i] = u8x8_font_read(&w, u8x8->font+offset);
       offset++;
     }
   }
@@ -392,6 +418,72 @@ uint8_t u8x8_DrawUTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
   return u8x8_draw_string(u8x8, x, y, s);
 }
 
+/*
+  Description:
+    Like u8x8_DrawString(), but only the glyphs of s which differ from the
+    glyph at the same position of prev (the string drawn there before) are
+    sent. Glyphs of several tiles (e.g. 2x3 fonts) are drawn in full size.
+    Per tile row, the tiles of adjacent changed glyphs are sent with one
+    u8x8_DrawTile() call of up to U8X8_DIFF_TILES tiles. Glyphs behind the
+    end of prev are always drawn, so an empty prev draws the whole string.
+    Glyphs of prev behind the end of s are not cleared. prev is set to s
+    and must have room for it. No UTF-8 decoding.
+  Returns:
+    Number of glyphs drawn
+*/
+#ifndef U8X8_DIFF_TILES
+#define U8X8_DIFF_TILES 16
+#endif
+uint8_t u8x8_DrawStringDiff(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s, char *prev)
+{
+  uint8_t th = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
+  uint8_t tv = u8x8_pgm_read(u8x8->font+3);		/* new 2019 format */
+  uint8_t buf[U8X8_DIFF_TILES*8];
+  uint8_t len = 0, prev_len = 0;
+  uint8_t i, row, col, cnt, start = 0;
+  uint8_t drawn = 0;
+  
+  while( s[len] != '\0' )
+    len++;
+  while( prev[prev_len] != '\0' )
+    prev_len++;
+  
+  for( row = 0; row < tv; row++ )
+  {
+    cnt = 0;
+    for( i = 0; i <= len; i++ )
+    {
+      if ( i < len && (i >= prev_len || prev[i] != s[i]) )
+      {
+	if ( row == 0 )
+	  drawn++;
+	for( col = 0; col < th; col++ )
+	{
+	  if ( cnt == U8X8_DIFF_TILES )
+	  {
+	    u8x8_DrawTile(u8x8, start, y+row, cnt, buf);
+	    cnt = 0;
+	  }
+	  if ( cnt == 0 )
+	    start = x + i*th + col;
+	  u8x8_get_glyph_data(u8x8, (uint8_t)s[i], buf+cnt*8, row*th+col);
+	  cnt++;
+	}
+      }
+      else if ( cnt > 0 )
+      {
+	/* end of a run of changed glyphs */
+	u8x8_DrawTile(u8x8, start, y+row, cnt, buf);
+	cnt = 0;
+      }
+    }
+  }
+  
+  for( i = 0; i <= len; i++ )
+    prev[i] = s[i];
+  return drawn;
+}
+
 
 
 static uint8_t u8x8_draw_2x2_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s) U8X8_NOINLINE;
@@ -595,6 +595,7 @@ uint8_t u8x8_byte_sw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_p
       
     case U8X8_MSG_BYTE_INIT:
       i2c_init(u8x8);
+      u8x8->i2c_max_transfer = 255;	/* bytes are sent directly, no buffer limit */
       break;
     case U8X8_MSG_BYTE_SET_DC:
       break;
@@ -631,7 +632,7 @@ void i2c_transfer(u8x8_t *u8x8, uint8_t adr, uint8_t cnt, uint8_t *data)
 
 uint8_t u8x8_byte_sw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
 {
-  static uint8_t buffer[32];		/* u8g2/u8x8 will never send more than 32 bytes */
+  static uint8_t buffer[32];		/* announced in i2c_max_transfer */
   static uint8_t buf_idx;
   uint8_t *data;
  
@@ -648,6 +649,7 @@ uint8_t u8x8_byte_sw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_p
       break;
     case U8X8_MSG_BYTE_INIT:
       i2c_init(u8x8);			/* init i2c communication */
+      u8x8->i2c_max_transfer = sizeof(buffer);
       break;
     case U8X8_MSG_BYTE_SET_DC:
       /* ignored for i2c */
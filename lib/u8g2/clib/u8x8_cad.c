@@ -606,6 +606,120 @@ uint8_t u8x8_cad_ssd13xx_fast_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, vo
 
 
 
+/*
+  SH1106 I2C with the commands merged into the data transfers.
+  Commands and args are collected and sent with the data which follows:
+  In the same transfer, each command byte gets its own control byte with the
+  continuation bit (0x080), the data follows the 0x040 control byte. So the
+  page and column address of a tile row go out with the tile data. Commands
+  which are not followed by data are sent with one 0x000 control byte.
+  Transfers are split so that they fit into u8x8->i2c_max_transfer bytes,
+  which is set by the byte procedure (e.g. the size of the Arduino Wire
+  buffer). If it is not set, at most 24 data bytes are sent per transfer:
+  The FeatherWing OLED with the 32u4 could not transfer longer streams.
+  
+  Collected commands go out only with the next data, at the end of the
+  transfer or when the buffer is full, but u8x8_cad_SendSequence() runs
+  U8X8_DLY() delays right away. So this is only for displays whose sequences
+  have no delays, like the SH1106 128x64; the other ssd13xx drivers use
+  u8x8_cad_ssd13xx_fast_i2c().
+*/
+#define U8X8_SH1106_CMD_BUF 16
+
+static uint8_t u8x8_sh1106_max_transfer(u8x8_t *u8x8)
+{
+  if ( u8x8->i2c_max_transfer == 0 )
+    return 25;		/* 24 data bytes and the control byte */
+  return u8x8->i2c_max_transfer;
+}
+
+static void u8x8_sh1106_send_cmds(u8x8_t *u8x8, uint8_t *cmd, uint8_t cnt)
+{
+  uint8_t n;
+  uint8_t max = u8x8_sh1106_max_transfer(u8x8)-1;
+  while( cnt > 0 )
+  {
+    n = cnt < max ? cnt : max;
+    u8x8_byte_StartTransfer(u8x8);
+    u8x8_byte_SendByte(u8x8, 0x000);	/* all bytes are commands */
+    u8x8_byte_SendBytes(u8x8, n, cmd);
+    u8x8_byte_EndTransfer(u8x8);
+    cmd += n;
+    cnt -= n;
+  }
+}
+
+uint8_t u8x8_cad_sh1106_fast_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  static uint8_t cmd_buf[U8X8_SH1106_CMD_BUF];
+  static uint8_t cmd_cnt = 0;
+  uint8_t *p;
+  uint8_t i, n;
+  switch(msg)
+  {
+    case U8X8_MSG_CAD_SEND_CMD:
+    case U8X8_MSG_CAD_SEND_ARG:
+      if ( cmd_cnt >= U8X8_SH1106_CMD_BUF )
+      {
+	u8x8_sh1106_send_cmds(u8x8, cmd_buf, cmd_cnt);
+	cmd_cnt = 0;
+      }
+      cmd_buf[cmd_cnt++] = arg_int;
+      break;
+    case U8X8_MSG_CAD_SEND_DATA:
+      n = u8x8_sh1106_max_transfer(u8x8)-1;
+      if ( cmd_cnt > 0 && (cmd_cnt*2 >= n || arg_int == 0) )
+      {
+	/* too many commands to share the transfer with the data */
+	u8x8_sh1106_send_cmds(u8x8, cmd_buf, cmd_cnt);
+	cmd_cnt = 0;
+      }
+      if ( arg_int == 0 )
+	break;
+      p = arg_ptr;
+      u8x8_byte_StartTransfer(u8x8);
+      for( i = 0; i < cmd_cnt; i++ )
+      {
+	u8x8_byte_SendByte(u8x8, 0x080);	/* one command byte, another control byte follows */
+	u8x8_byte_SendByte(u8x8, cmd_buf[i]);
+      }
+      n -= cmd_cnt*2;
+      cmd_cnt = 0;
+      for(;;)
+      {
+	u8x8_byte_SendByte(u8x8, 0x040);	/* all bytes are data */
+	if ( n > arg_int )
+	  n = arg_int;
+	u8x8_byte_SendBytes(u8x8, n, p);
+	u8x8_byte_EndTransfer(u8x8);
+	arg_int -= n;
+	p += n;
+	if ( arg_int == 0 )
+	  break;
+	u8x8_byte_StartTransfer(u8x8);
+	n = u8x8_sh1106_max_transfer(u8x8)-1;
+      }
+      break;
+    case U8X8_MSG_CAD_INIT:
+      /* apply default i2c adr if required so that the start transfer msg can use this */
+      if ( u8x8->i2c_address == 255 )
+	u8x8->i2c_address = 0x078;
+      return u8x8->byte_cb(u8x8, msg, arg_int, arg_ptr);
+    case U8X8_MSG_CAD_START_TRANSFER:
+      break;
+    case U8X8_MSG_CAD_END_TRANSFER:
+      if ( cmd_cnt > 0 )
+	u8x8_sh1106_send_cmds(u8x8, cmd_buf, cmd_cnt);
+      cmd_cnt = 0;
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+
+
 /* the st75256 i2c driver is a copy of the ssd13xx driver, but with arg=1 */
 /* modified from cad001 (ssd13xx) to cad011 */
 uint8_t u8x8_cad_st75256_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
@@ -54,6 +54,9 @@ void u8x8_d_helper_display_setup_memory(u8x8_t *u8x8, const u8x8_display_info_t
       /* 1) set display info struct */
       u8x8->display_info = display_info;
       u8x8->x_offset = u8x8->display_info->default_x_offset;
+#ifdef U8X8_WITH_START_LINE
+      u8x8->start_line = 0;
+#endif
 }
 
 /*
@@ -158,6 +161,21 @@ void u8x8_RefreshDisplay(u8x8_t *u8x8)
   u8x8->display_cb(u8x8, U8X8_MSG_DISPLAY_REFRESH, 0, NULL);  
 }
 
+#ifdef U8X8_WITH_START_LINE
+/* line is taken modulo the RAM height (pixel_height of the display) */
+void u8x8_SetStartLine(u8x8_t *u8x8, uint8_t line)
+{
+  line %= u8x8->display_info->pixel_height;
+  u8x8->display_cb(u8x8, U8X8_MSG_DISPLAY_SET_START_LINE, line, NULL);  
+}
+
+/* same as u8x8_DrawTile(), but "row" is the tile row on the screen */
+void u8x8_DrawRingTile(u8x8_t *u8x8, uint8_t x, uint8_t row, uint8_t cnt, uint8_t *tile_ptr)
+{
+  u8x8_DrawTile(u8x8, x, u8x8_GetRingRow(u8x8, row), cnt, tile_ptr);
+}
+#endif
+
 void u8x8_ClearDisplayWithTile(u8x8_t *u8x8, const uint8_t *buf)
 {
   u8x8_tile_t tile;
@@ -0,0 +1,71 @@
+#include "fixed_format.h"
+
+#include "profiler.h"
+
+static const uint16_t round_divisor[] = {1000, 100, 10, 1};
+
+size_t format_milli(char *buf, size_t size, int32_t milli, uint8_t decimals,
+                    const char *unit, uint8_t width) {
+  PROFILE_SCOPE(PROFILE_FORMAT);
+  if (decimals > 3)
+    decimals = 3;
+  bool negative = milli < 0;
+  uint32_t value = negative ? 0U - static_cast<uint32_t>(milli)
+                            : static_cast<uint32_t>(milli);
+  uint16_t div = round_divisor[decimals];
+  value = (value + div / 2) / div;
+
+  // digits backwards, with the decimal point after `decimals` digits
+  char tmp[16];
+  uint8_t len = 0;
+  for (uint8_t i = 0; i < decimals; i++) {
+    tmp[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  if (decimals > 0)
+    tmp[len++] = '.';
+  do {
+    tmp[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  if (negative)
+    tmp[len++] = '-';
+
+  size_t unit_len = 0;
+  while (unit != nullptr && unit[unit_len] != '\0')
+    unit_len++;
+  size_t total = len + unit_len;
+  size_t pad = total < width ? width - total : 0;
+  if (pad + total + 1 > size)
+    return 0;
+
+  char *p = buf;
+  for (size_t i = 0; i < pad; i++)
+    *p++ = ' ';
+  while (len > 0)
+    *p++ = tmp[--len];
+  for (size_t i = 0; i < unit_len; i++)
+    *p++ = unit[i];
+  *p = '\0';
+  return p - buf;
+}
+
+size_t format_milli_auto(char *buf, size_t size, int32_t milli,
+                         uint8_t decimals, char unit, uint8_t width) {
+  char name[3];
+  if (milli > -1000 && milli < 1000) {
+    name[0] = 'm';
+    name[1] = unit;
+    name[2] = '\0';
+    // print the milli value itself: scale up so that no decimals remain
+    return format_milli(buf, size, milli * 1000, 0, name, width);
+  }
+  name[0] = unit;
+  name[1] = '\0';
+  return format_milli(buf, size, milli, decimals, name, width);
+}
+
+int32_t milliwatts(int32_t millivolt, int32_t milliamps) {
+  int64_t uw = static_cast<int64_t>(millivolt) * milliamps;
+  return static_cast<int32_t>(uw >= 0 ? (uw + 500) / 1000 : (uw - 500) / 1000);
+}
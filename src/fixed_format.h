@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-only replacement for printf("%0.Nf<unit>") on values given in
+// milli-units (mV, mA, mW). No floats, no heap.
+//
+// Rounding is half away from zero on the exact value, so the output matches
+// printf of the exact decimal value; printf of a float can differ where the
+// float is not exactly representable (e.g. 1.005). A negative value keeps its
+// sign even if it rounds to zero ("-0.00"), like printf.
+
+// Writes milli / 1000 with `decimals` (0..3) fractional digits followed by
+// `unit`, right-aligned in a field of at least `width` characters. Returns
+// the length written, or 0 if buf (including the terminator) is too small.
+size_t format_milli(char *buf, size_t size, int32_t milli, uint8_t decimals,
+                    const char *unit, uint8_t width = 0);
+
+// Like format_milli(), but values below 1000 milli-units are shown in the
+// milli unit without decimals ("950mA"), larger ones in the base unit with
+// `decimals` fractional digits ("1.25A").
+size_t format_milli_auto(char *buf, size_t size, int32_t milli,
+                         uint8_t decimals, char unit, uint8_t width = 0);
+
+// mV * mA in mW, rounded half away from zero.
+int32_t milliwatts(int32_t millivolt, int32_t milliamps);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <clib/u8g2.h>
+#include <stdint.h>
+
+// The fonts of the firmware, reduced to the characters it draws.
+//
+// host/font_subset generates font_subsets.c from font_subsets[] below: each
+// subset keeps the header (metrics) and the glyph data of the full u8g2 font,
+// in the same ascending order, but only for the listed characters. That cuts
+// the linked font data to a few hundred bytes, and the glyph lookup (and the
+// glyph index build on setFont) walks only these glyphs. With -DFONT_SUBSETS
+// the FONT_* names select the subsets, otherwise the full fonts. A character
+// missing from a set is not drawn, so literal strings are checked against the
+// sets at compile time with font_has_chars().
+
+// what format_milli() and format_milli_auto() write besides the unit
+#define FONT_NUMBER_CHARS "-.0123456789"
+
+constexpr char FONT_10_CHARS[] = FONT_NUMBER_CHARS " AVs";
+constexpr char FONT_12_CHARS[] = FONT_NUMBER_CHARS " ABMPSUWemorstw";
+constexpr char FONT_17_CHARS[] = FONT_NUMBER_CHARS "VW";
+constexpr char FONT_29_CHARS[] = FONT_NUMBER_CHARS "AMWacek";
+
+struct font_subset {
+  const char *name;    // of the generated font array
+  const uint8_t *font; // full u8g2 font
+  const char *chars;
+};
+
+constexpr font_subset font_subsets[] = {
+    {"u8g2_font_profont10_subset", u8g2_font_profont10_tr, FONT_10_CHARS},
+    {"u8g2_font_profont12_subset", u8g2_font_profont12_tr, FONT_12_CHARS},
+    {"u8g2_font_profont17_subset", u8g2_font_profont17_tr, FONT_17_CHARS},
+    {"u8g2_font_profont29_subset", u8g2_font_profont29_tr, FONT_29_CHARS},
+};
+
+// True if every character of s is in chars.
+constexpr bool font_has_chars(const char *chars, const char *s) {
+  for (; *s != '\0'; s++) {
+    const char *c = chars;
+    while (*c != '\0' && *c != *s)
+      c++;
+    if (*c == '\0')
+      return false;
+  }
+  return true;
+}
+
+#ifdef FONT_SUBSETS
+extern "C" {
+extern const uint8_t u8g2_font_profont10_subset[] U8G2_FONT_SECTION("u8g2_font_profont10_subset");
+extern const uint8_t u8g2_font_profont12_subset[] U8G2_FONT_SECTION("u8g2_font_profont12_subset");
+extern const uint8_t u8g2_font_profont17_subset[] U8G2_FONT_SECTION("u8g2_font_profont17_subset");
+extern const uint8_t u8g2_font_profont29_subset[] U8G2_FONT_SECTION("u8g2_font_profont29_subset");
+}
+#define FONT_10 u8g2_font_profont10_subset
+#define FONT_12 u8g2_font_profont12_subset
+#define FONT_17 u8g2_font_profont17_subset
+#define FONT_29 u8g2_font_profont29_subset
+#else
+#define FONT_10 u8g2_font_profont10_tr
+#define FONT_12 u8g2_font_profont12_tr
+#define FONT_17 u8g2_font_profont17_tr
+#define FONT_29 u8g2_font_profont29_tr
+#endif
@@ -0,0 +1,129 @@
+#include "i2c_bus.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <string.h>
+
+struct bus_device {
+  const char *name;
+  uint32_t clock_hz;
+  uint8_t priority;
+  void (*service)();
+  uint32_t started_us;
+  bus_stats stats;
+};
+
+static bus_device devices[BUS_MAX_DEVICES];
+static uint8_t device_count = 0;
+static uint32_t current_clock = 0; // 0: not set yet
+static uint32_t clock_switches = 0;
+static bool in_service = false;
+
+uint8_t bus_add_device(const char *name, uint32_t clock_hz, uint8_t priority) {
+  if (device_count == BUS_MAX_DEVICES)
+    return BUS_NO_DEVICE;
+  bus_device &d = devices[device_count];
+  d.name = name;
+  d.clock_hz = clock_hz;
+  d.priority = priority;
+  d.service = nullptr;
+  d.stats = bus_stats();
+  return device_count++;
+}
+
+void bus_set_service(uint8_t device, void (*service)()) {
+  if (device < device_count)
+    devices[device].service = service;
+}
+
+void bus_begin(uint8_t device) {
+  if (device >= device_count)
+    return;
+  bus_device &d = devices[device];
+  if (d.clock_hz != current_clock) {
+    Wire.setClock(d.clock_hz);
+    current_clock = d.clock_hz;
+    clock_switches++;
+  }
+  d.started_us = micros();
+}
+
+void bus_end(uint8_t device) {
+  if (device >= device_count)
+    return;
+  bus_device &d = devices[device];
+  uint32_t us = micros() - d.started_us;
+  d.stats.transactions++;
+  d.stats.busy_us += us;
+  if (us > d.stats.max_us)
+    d.stats.max_us = us;
+
+  if (in_service)
+    return;
+  in_service = true;
+  for (uint8_t i = 0; i < device_count; i++) {
+    if (devices[i].service != nullptr && devices[i].priority > d.priority)
+      devices[i].service();
+  }
+  in_service = false;
+}
+
+uint8_t bus_device_count() { return device_count; }
+
+uint8_t bus_find_device(const char *name) {
+  for (uint8_t i = 0; i < device_count; i++) {
+    if (strcmp(devices[i].name, name) == 0)
+      return i;
+  }
+  return BUS_NO_DEVICE;
+}
+
+const char *bus_device_name(uint8_t device) { return devices[device].name; }
+
+const bus_stats &bus_device_stats(uint8_t device) { return devices[device].stats; }
+
+uint32_t bus_clock_switches() { return clock_switches; }
+
+void bus_clear_stats() {
+  for (uint8_t i = 0; i < device_count; i++)
+    devices[i].stats = bus_stats();
+  clock_switches = 0;
+}
+
+extern "C" uint8_t u8x8_byte_bus_i2c(u8x8_t *u8x8, uint8_t msg,
+                                     uint8_t arg_int, void *arg_ptr) {
+  // BUS_NO_DEVICE if the table was full: the display then writes to Wire
+  // without arbitration, at the clock of the transaction before
+  static uint8_t device = BUS_NO_DEVICE;
+
+  switch (msg) {
+  case U8X8_MSG_BYTE_SEND:
+    Wire.write(static_cast<uint8_t *>(arg_ptr), arg_int);
+    if (device != BUS_NO_DEVICE)
+      devices[device].stats.bytes += arg_int;
+    break;
+  case U8X8_MSG_BYTE_INIT:
+    if (u8x8->bus_clock == 0)
+      u8x8->bus_clock = u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+    u8x8->i2c_max_transfer = BUFFER_LENGTH < 255 ? BUFFER_LENGTH : 255;
+    if (device == BUS_NO_DEVICE)
+      device = bus_add_device("display", u8x8->bus_clock, 0);
+    Wire.begin();
+    break;
+  case U8X8_MSG_BYTE_SET_DC:
+    break;
+  case U8X8_MSG_BYTE_START_TRANSFER:
+    if (device != BUS_NO_DEVICE)
+      bus_begin(device);
+    Wire.beginTransmission(u8x8_GetI2CAddress(u8x8) >> 1);
+    break;
+  case U8X8_MSG_BYTE_END_TRANSFER:
+    Wire.endTransmission();
+    if (device != BUS_NO_DEVICE)
+      bus_end(device);
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <clib/u8x8.h>
+#include <stdint.h>
+
+// Arbiter for the devices sharing Wire (INA226 and SH1106).
+//
+// Every transaction of a device is enclosed in bus_begin() / bus_end().
+// bus_begin() switches the bus clock only if the device needs another one
+// than the previous transaction, so each device runs at its own clock.
+// bus_end() accounts the bus time of the device and then runs the service
+// hooks of the devices with a higher priority. A sensor poll registered as
+// service hook thus preempts a long display transfer at the next transaction
+// boundary: a due poll waits for at most one display transaction (at most
+// i2c_max_transfer bytes, ~3 ms at 400 kHz), not for the whole frame.
+
+#define BUS_MAX_DEVICES 4
+#define BUS_NO_DEVICE 0xff
+
+struct bus_stats {
+  uint32_t transactions;
+  uint32_t busy_us; // sum of the transaction times
+  uint32_t max_us;  // longest transaction
+  uint32_t bytes;   // written by u8x8_byte_bus_i2c, without the address
+};
+
+// Adds a device and returns its number, BUS_NO_DEVICE if the table is full.
+uint8_t bus_add_device(const char *name, uint32_t clock_hz, uint8_t priority);
+
+// service is called after each transaction of a device with a lower priority
+// (not from within another service hook). It must check itself whether there
+// is work to do.
+void bus_set_service(uint8_t device, void (*service)());
+
+// Both do nothing for BUS_NO_DEVICE, the transaction is then not arbitrated.
+void bus_begin(uint8_t device);
+void bus_end(uint8_t device);
+
+uint8_t bus_device_count();
+// BUS_NO_DEVICE if there is no device of that name
+uint8_t bus_find_device(const char *name);
+const char *bus_device_name(uint8_t device);
+const bus_stats &bus_device_stats(uint8_t device);
+// Wire.setClock() calls since the last bus_clear_stats()
+uint32_t bus_clock_switches();
+void bus_clear_stats();
+
+// u8x8 byte procedure for a display on the bus. It adds the device "display"
+// with priority 0 and the display's bus clock on U8X8_MSG_BYTE_INIT. If the
+// table is full, the display is sent without arbitration and statistics.
+extern "C" uint8_t u8x8_byte_bus_i2c(u8x8_t *u8x8, uint8_t msg,
+                                     uint8_t arg_int, void *arg_ptr);
@@ -1,34 +1,124 @@
 #include <Arduino.h>
 #include <INA226_WE.h>
+#include <U8g2Fixed.h>
 #include <U8g2lib.h>
 #include <Wire.h>
 
+#include "fixed_format.h"
+#include "font_subsets.h"
+#include "i2c_bus.h"
+#include "meter_screen.h"
+#include "profiler.h"
+#include "strip_chart.h"
+#include "text_layout.h"
+#include "tile_readout.h"
+
+#ifndef U8X8_WITH_START_LINE
+#error "the log screen scrolls with the display start line, build with -DU8X8_WITH_START_LINE (see platformio.ini)"
+#endif
+
 #define MY_BLUE_LED_PIN D4
 #define RELEASE_VERSION "1.2.2"
+#define SPLASH_TITLE "MacWake"
+#define SPLASH_SUBTITLE "USB Power Meter"
 
 #define DEBUG_LED_PEAK_DETECT 0
 #define DEBUG_INA 0
 #define SCREENSAVER_DELAY 10000
+// Once the screensaver has run for SCREENSAVER_POWER_SAVE the panel is switched
+// off and nothing is rendered or sent; the first sample with a voltage switches
+// it on and renders a frame right away.
+#define SCREENSAVER_POWER_SAVE 60000
+// The INA226 is polled for a finished conversion every SAMPLE_POLL_MS; the
+// display is redrawn every FRAME_INTERVAL_MS independently of that. The
+// changed tiles of a frame are queued and sent in steps of at most
+// FRAME_STEP_TILES tiles, one I2C transaction of the 128 byte Wire buffer
+// (~3 ms on the bus), with sensor polls in between; a due poll also preempts
+// the display at the next I2C transaction (see i2c_bus.h).
+#define SAMPLE_POLL_MS 5
+// The INA226 supports fast mode; the display clock comes from u8x8.
+#define SENSOR_I2C_CLOCK 400000
+#define FRAME_INTERVAL_MS 150
+#define FRAME_STEP_TILES 14
+#define DISPLAY_BUFFER_SIZE (128 * 64 / 8)
+// The graph screen plots current or power below a header of GRAPH_TOP rows,
+// over GRAPH_DEFAULT_SECONDS unless the "screen" command sets another span.
+#define SCREEN_METER 0
+#define SCREEN_GRAPH 1
+#define GRAPH_TOP 16
+#define GRAPH_DEFAULT_SECONDS 64
+// The log screen adds a line every LOG_LINE_MS and scrolls with the display
+// start line.
+#define SCREEN_LOG 2
+#define LOG_LINE_MS 1000
+// Built with -DTILE_READOUT, the meter screen is drawn with u8x8 tiles
+// straight to the display (see tile_readout.h) instead of the u8g2 buffer.
+
+// Like U8G2_SH1106_128X64_NONAME_F_HW_I2C, but the display transfers go
+// through the bus arbiter (see i2c_bus.h) with the commands merged into the
+// data transfers (u8x8_cad_sh1106_fast_i2c), and drawing writes straight into
+// the buffer of the fixed geometry (see U8g2Fixed.h).
+class U8G2_SH1106_128X64_NONAME_F_BUS_I2C
+    : public U8G2_FIXED<128, 64, U8G2_FIXED_VERTICAL_TOP_LSB, U8G2_FIXED_R0> {
+public:
+  U8G2_SH1106_128X64_NONAME_F_BUS_I2C() {
+    u8g2_Setup_sh1106_i2c_128x64_noname_f(&u8g2, setupRotation(),
+                                          u8x8_byte_bus_i2c,
+                                          u8x8_gpio_and_delay_arduino);
+    u8x8_SetPin_HW_I2C(getU8x8(), U8X8_PIN_NONE, U8X8_PIN_NONE, U8X8_PIN_NONE);
+    // page and column address go out with the tile data
+    getU8x8()->cad_cb = u8x8_cad_sh1106_fast_i2c;
+  }
 
-U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0);
+#ifdef PROFILER
+  u8g2_uint_t drawStr(u8g2_uint_t x, u8g2_uint_t y, const char *s) {
+    PROFILE_SCOPE(PROFILE_TEXT);
+    return U8G2_FIXED::drawStr(x, y, s);
+  }
+#endif
+};
+
+U8G2_SH1106_128X64_NONAME_F_BUS_I2C u8g2;
 INA226_WE ina226;
+uint8_t sensor_bus = BUS_NO_DEVICE;
+uint8_t display_bus = BUS_NO_DEVICE;
+// What the display shows once the queue is sent, so that only tiles that
+// changed are sent (see u8g2_QueueUpdate).
+uint8_t display_shadow[DISPLAY_BUFFER_SIZE];
+uint8_t display_dirty[DISPLAY_BUFFER_SIZE / 8 / 8];
+u8g2_tile_queue_t display_queue;
+uint8_t screen = SCREEN_METER;
+bool graph_power = false;
+uint16_t graph_seconds = GRAPH_DEFAULT_SECONDS;
+strip_chart chart;
+bool log_restart = false;
+#ifdef TILE_READOUT
+tile_readout readout;
+// the display shows the tile readout, not the shadow of the tile queue
+bool readout_shown = false;
+#endif
 
 void splash() {
   char buf[64];
+  static_assert(font_has_chars(FONT_29_CHARS, SPLASH_TITLE), "FONT_29_CHARS");
+  static_assert(font_has_chars(FONT_12_CHARS, SPLASH_SUBTITLE), "FONT_12_CHARS");
+  static_assert(font_has_chars(FONT_10_CHARS, "V" RELEASE_VERSION), "FONT_10_CHARS");
   u8g2.firstPage();
-  u8g2.setFont(u8g2_font_profont29_tr);
-  sprintf(buf, "MacWake");
+  u8g2.setFont(FONT_29);
+  sprintf(buf, SPLASH_TITLE);
   u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(buf)) / 2,
                (u8g2.getDisplayHeight() / 2) + u8g2.getFontAscent() / 2, buf);
-  u8g2.setFont(u8g2_font_profont12_tr);
-  sprintf(buf, "USB Power Meter");
+  u8g2.setFont(FONT_12);
+  sprintf(buf, SPLASH_SUBTITLE);
   u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(buf)) / 2,
                (u8g2.getDisplayHeight() / 2) + u8g2.getFontAscent() / 2 + 16,
                buf);
-  u8g2.setFont(u8g2_font_profont10_tr);
+  u8g2.setFont(FONT_10);
   sprintf(buf, "V%s", RELEASE_VERSION);
   u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(buf)) / 2, 62, buf);
   u8g2.nextPage();
+  memcpy(display_shadow, u8g2.getBufferPtr(), sizeof(display_shadow));
+  u8g2_InitTileQueue(&display_queue, display_shadow, display_dirty);
   delay(1500);
 }
 
@@ -66,6 +156,9 @@ static uint8_t findInaAddress() {
   }
   return 0;
 }
+// registered as bus service at the end of setup()
+void poll_sensor();
+
 void setup() {
   Serial.begin(9600);
   Serial.println();
@@ -75,9 +168,12 @@ void setup() {
           OUTPUT); // Initialize the LED_BUILTIN pin as an output
 
   u8g2.begin();
+  display_bus = bus_find_device("display");
 
   Wire.begin();
 
+  sensor_bus = bus_add_device("sensor", SENSOR_I2C_CLOCK, 1);
+  bus_begin(sensor_bus);
   uint8_t ina_address = findInaAddress();
   if (ina_address == 0) {
     Serial.println("INA226 not found");
@@ -99,42 +195,428 @@ void setup() {
   ina226.setMeasureMode(CONTINUOUS);
   ina226.setResistorRange(0.01, 6.0);
   ina226.setCorrectionFactor(0.975); // must be aligned with good load
+  bus_end(sensor_bus);
 
+  chart_reset(chart, graph_seconds * 1000UL / CHART_COLUMNS, millis());
   splash();
+  bus_set_service(sensor_bus, poll_sensor);
 }
 
 char hexdigit(uint8_t nibble) {
   return nibble < 10 ? nibble + '0' : nibble - 10 + 'A';
 }
 
+void byte2hex(uint8_t val, char *buf) {
+  buf[0] = hexdigit(val >> 4);
+  buf[1] = hexdigit(val & 0x0f);
+}
+
 void int2hex(int16_t val, char *buf) {
-  buf[0] = hexdigit((highByte(val) >> 4) & 0x0f);
-  buf[1] = hexdigit((highByte(val)) & 0x0f);
-  buf[2] = hexdigit((lowByte(val) >> 4) & 0x0f);
-  buf[3] = hexdigit((lowByte(val)) & 0x0f);
+  byte2hex(highByte(val), buf);
+  byte2hex(lowByte(val), buf + 2);
 }
 
-void serial_out(int milliamps, int millivolt) {
-  float shuntval = -milliamps / 0.2;
-  float voltval = millivolt / 3.125;
-  int16_t shunt_ser = shuntval;
-  int16_t volt_ser = voltval;
+void long2hex(uint32_t val, char *buf) {
+  int2hex(static_cast<int16_t>(val >> 16), buf);
+  int2hex(static_cast<int16_t>(val & 0xffff), buf + 4);
+}
 
-  char buf[16];
+// The serial link carries one frame per line, each terminated by 0x1c '\n':
+//   SSSSVVVVTTTTTTTT             raw sample: shunt, bus voltage and the
+//                                micros() timestamp of the reading
+//   =cNNNNaaaabbbbccccxxxxyyyyzzzzTTTTTTTT
+//                                statistics of channel c over NNNN samples:
+//                                shunt min/max/mean, voltage min/max/mean and
+//                                the timestamp of the last sample
+// All values are hex in the units of the raw sample. The timestamp wraps every
+// ~71.6 minutes; the host extends it to 64 bit (see host/meter_protocol.h).
+//
+// The host subscribes with newline terminated commands:
+//   raw off | raw <min_interval_ms>
+//   stat <channel> off | stat <channel> <samples> [min_interval_ms]
+//   mirror off | mirror <min_interval_ms>
+//   timing                       per stage timing, glyph cache hits, bus
+//                                time per I2C device and the display bytes
+//                                per second of screensaver since the last
+//                                report
+//   profile                      min/mean/p99/max in us of each stage of
+//                                profiler.h since the last report (firmware
+//                                built with -DPROFILER)
+//   screen meter | screen graph [current|power] [seconds] | screen log
+//                                select the display screen; the graph shows
+//                                the last <seconds> (default 64)
+// A statistics window is closed once it holds <samples> samples and
+// <min_interval_ms> have passed since the last frame of that channel.
+//
+// While mirroring, each tile row of the display buffer that changed since the
+// last mirrored frame is sent as
+//   #rMMMM<16 hex digits per changed tile>
+// where r is the tile row on the screen and bit n of MMMM marks tile column
+// n as present. A scroll of the log screen resends all rows.
+// Enabling the mirror resends the whole buffer. A frame is sent over several
+// loop passes, each no more than fits into the transmit FIFO, so the mirror
+// never blocks the loop; a row may come as several frames. The tile readout
+// of the meter screen (-DTILE_READOUT) does not use the buffer and is not
+// mirrored.
+//
+// Lines starting with '!' are human readable info frames.
+#define STAT_CHANNELS 2
+#define MIRROR_TILE_COLS 16
+#define MIRROR_TILE_ROWS 8
+#define MIRROR_FRAME_OVERHEAD 8 // #rMMMM, 0x1c and '\n'
+#define MIRROR_SERIAL_RESERVE 32 // transmit FIFO left for sample frames
+#define CMD_BUF_SIZE 32
+
+struct stat_channel {
+  uint16_t decimation; // 0: channel disabled
+  uint16_t min_interval_ms;
+  unsigned long last_sent;
+  uint16_t count;
+  int16_t shunt_min, shunt_max;
+  int32_t shunt_sum;
+  int16_t volt_min, volt_max;
+  int32_t volt_sum;
+};
+
+bool raw_enabled = true;
+uint16_t raw_interval_ms = 0;
+unsigned long raw_last_sent = 0;
+stat_channel stat_channels[STAT_CHANNELS];
+bool mirror_enabled = false;
+bool mirror_resync = false;
+uint16_t mirror_interval_ms = 0;
+unsigned long mirror_last_sent = 0;
+// frame being sent: next tile (row * MIRROR_TILE_COLS + column), all tiles
+// or only changed ones
+bool mirror_busy = false;
+bool mirror_full = false;
+uint8_t mirror_tile = 0;
+uint8_t mirror_shadow[MIRROR_TILE_COLS * MIRROR_TILE_ROWS * 8];
+
+void serial_out(int16_t shunt_ser, int16_t volt_ser, uint32_t timestamp) {
+  char buf[20];
   int2hex(shunt_ser, buf);
   int2hex(volt_ser, buf + 4);
-  buf[8] = 28;
-  buf[9] = '\n';
-  buf[10] = '\0';
+  long2hex(timestamp, buf + 8);
+  buf[16] = 28;
+  buf[17] = '\n';
+  buf[18] = '\0';
   Serial.print(buf);
 }
 
-void read_ina(int *shunt, int *millivolt, int *current) {
+void stat_out(uint8_t channel, const stat_channel &ch, uint32_t timestamp) {
+  char buf[44];
+  buf[0] = '=';
+  buf[1] = hexdigit(channel);
+  int2hex(ch.count, buf + 2);
+  int2hex(ch.shunt_min, buf + 6);
+  int2hex(ch.shunt_max, buf + 10);
+  int2hex(ch.shunt_sum / ch.count, buf + 14);
+  int2hex(ch.volt_min, buf + 18);
+  int2hex(ch.volt_max, buf + 22);
+  int2hex(ch.volt_sum / ch.count, buf + 26);
+  long2hex(timestamp, buf + 30);
+  buf[38] = 28;
+  buf[39] = '\n';
+  buf[40] = '\0';
+  Serial.print(buf);
+}
+
+void stat_reset(stat_channel &ch) {
+  ch.count = 0;
+  ch.shunt_sum = 0;
+  ch.volt_sum = 0;
+}
+
+void stat_add(uint8_t channel, stat_channel &ch, int16_t shunt_ser,
+              int16_t volt_ser, uint32_t timestamp) {
+  if (ch.count == 0 || shunt_ser < ch.shunt_min)
+    ch.shunt_min = shunt_ser;
+  if (ch.count == 0 || shunt_ser > ch.shunt_max)
+    ch.shunt_max = shunt_ser;
+  if (ch.count == 0 || volt_ser < ch.volt_min)
+    ch.volt_min = volt_ser;
+  if (ch.count == 0 || volt_ser > ch.volt_max)
+    ch.volt_max = volt_ser;
+  ch.shunt_sum += shunt_ser;
+  ch.volt_sum += volt_ser;
+  ch.count++;
+
+  unsigned long now = millis();
+  if ((ch.count >= ch.decimation && now - ch.last_sent >= ch.min_interval_ms) ||
+      ch.count == 0xffff) {
+    stat_out(channel, ch, timestamp);
+    ch.last_sent = now;
+    stat_reset(ch);
+  }
+}
+
+// Feeds one sample into every subscribed channel.
+void stream_sample(int milliamps, int millivolt, uint32_t timestamp) {
+  PROFILE_SCOPE(PROFILE_SERIAL);
+  // same as -milliamps / 0.2 and millivolt / 3.125, without floats
+  int16_t shunt_ser = -milliamps * 5;
+  int16_t volt_ser = millivolt * 8 / 25;
+
+  unsigned long now = millis();
+  if (raw_enabled && now - raw_last_sent >= raw_interval_ms) {
+    serial_out(shunt_ser, volt_ser, timestamp);
+    raw_last_sent = now;
+  }
+  for (uint8_t i = 0; i < STAT_CHANNELS; i++) {
+    if (stat_channels[i].decimation != 0)
+      stat_add(i + 1, stat_channels[i], shunt_ser, volt_ser, timestamp);
+  }
+}
+
+// Everything acquired since the last frame. The display shows the latest
+// values and marks the current range of the window on the bar.
+struct frame_window {
+  int millivolt;
+  uint8_t volt_norm;
+  int milliamps;
+  int max_current;
+  int min_abs_milliamps, max_abs_milliamps;
+  uint16_t samples;
+};
+
+struct stage_stats {
+  uint32_t count;
+  uint32_t total_us;
+  uint32_t max_us;
+};
+
+frame_window window;
+stage_stats acquire_stats, render_stats, transfer_stats;
+uint32_t samples_acquired = 0;
+// Idle: the screensaver runs or the panel is off. Time spent idle and the
+// display bytes sent meanwhile, since the last timing report.
+bool display_idle = false;
+bool display_off = false;
+uint32_t idle_ms = 0;
+uint32_t idle_display_bytes = 0;
+unsigned long timing_since = 0;
+
+void stage_add(stage_stats &stats, uint32_t us) {
+  stats.count++;
+  stats.total_us += us;
+  if (us > stats.max_us)
+    stats.max_us = us;
+}
+
+void stage_print(const char *name, const stage_stats &stats, uint32_t ms) {
+  Serial.printf(" %s=%lu/s avg=%luus max=%luus", name,
+                static_cast<unsigned long>(stats.count * 1000UL / ms),
+                static_cast<unsigned long>(stats.count ? stats.total_us / stats.count : 0),
+                static_cast<unsigned long>(stats.max_us));
+}
+
+// Answers the "timing" command with the stage statistics since the last
+// report, as an info frame.
+void timing_report() {
+  uint32_t ms = millis() - timing_since;
+  if (ms == 0)
+    ms = 1;
+  Serial.printf("!timing samples=%lu/s",
+                static_cast<unsigned long>(samples_acquired * 1000UL / ms));
+  stage_print("acquire", acquire_stats, ms);
+  stage_print("render", render_stats, ms);
+  stage_print("transfer", transfer_stats, ms);
+#ifdef U8G2_WITH_GLYPH_CACHE
+  Serial.printf(" glyph_hits=%lu glyph_misses=%lu",
+                static_cast<unsigned long>(u8g2_GetGlyphCacheHits()),
+                static_cast<unsigned long>(u8g2_GetGlyphCacheMisses()));
+  u8g2_ClearGlyphCacheStats();
+#endif
+  for (uint8_t i = 0; i < bus_device_count(); i++) {
+    const bus_stats &bus = bus_device_stats(i);
+    Serial.printf(" bus_%s=%lu/s busy=%luus/s max=%luus bytes=%lu/s",
+                  bus_device_name(i),
+                  static_cast<unsigned long>(bus.transactions * 1000ULL / ms),
+                  static_cast<unsigned long>(bus.busy_us * 1000ULL / ms),
+                  static_cast<unsigned long>(bus.max_us),
+                  static_cast<unsigned long>(bus.bytes * 1000ULL / ms));
+  }
+  Serial.printf(" clock_switches=%lu",
+                static_cast<unsigned long>(bus_clock_switches()));
+  Serial.printf(" idle=%lums idle_display_bytes=%lu/s",
+                static_cast<unsigned long>(idle_ms),
+                static_cast<unsigned long>(
+                    idle_ms ? idle_display_bytes * 1000ULL / idle_ms : 0));
+  bus_clear_stats();
+  Serial.print("\x1c\n");
+  acquire_stats = stage_stats();
+  render_stats = stage_stats();
+  transfer_stats = stage_stats();
+  samples_acquired = 0;
+  idle_ms = 0;
+  idle_display_bytes = 0;
+  timing_since = millis();
+}
+
+#ifdef PROFILER
+// Prints ticks in us with one decimal.
+static void print_us(const char *name, uint32_t ticks, uint32_t ticks_per_us) {
+  uint64_t tenths = static_cast<uint64_t>(ticks) * 10 / ticks_per_us;
+  Serial.printf(" %s=%lu.%lu", name, static_cast<unsigned long>(tenths / 10),
+                static_cast<unsigned long>(tenths % 10));
+}
+
+// Answers the "profile" command with the latency of each stage since the
+// last report, as an info frame.
+void profile_report() {
+  uint32_t ticks_per_us = profile_ticks_per_us();
+  Serial.print("!profile");
+  for (uint8_t stage = 0; stage < PROFILE_STAGES; stage++) {
+    profile_summary s = profile_summarize(stage);
+    Serial.printf(" %s:n=%lu", profile_stage_name(stage),
+                  static_cast<unsigned long>(s.count));
+    print_us("min", s.min, ticks_per_us);
+    print_us("mean", s.mean, ticks_per_us);
+    print_us("p99", s.p99, ticks_per_us);
+    print_us("max", s.max, ticks_per_us);
+  }
+  Serial.print("\x1c\n");
+  profile_clear();
+}
+#endif
+
+void handle_command(char *cmd) {
+  char *word = strtok(cmd, " ");
+  if (word == nullptr)
+    return;
+  char *arg1 = strtok(nullptr, " ");
+  char *arg2 = strtok(nullptr, " ");
+  char *arg3 = strtok(nullptr, " ");
+
+  if (strcmp(word, "raw") == 0 && arg1 != nullptr) {
+    raw_enabled = strcmp(arg1, "off") != 0;
+    raw_interval_ms = raw_enabled ? constrain(atoi(arg1), 0, 0xffff) : 0;
+  } else if (strcmp(word, "timing") == 0) {
+    timing_report();
+#ifdef PROFILER
+  } else if (strcmp(word, "profile") == 0) {
+    profile_report();
+#endif
+  } else if (strcmp(word, "mirror") == 0 && arg1 != nullptr) {
+    mirror_enabled = strcmp(arg1, "off") != 0;
+    mirror_interval_ms = mirror_enabled ? constrain(atoi(arg1), 0, 0xffff) : 0;
+    mirror_resync = true;
+    mirror_busy = false;
+  } else if (strcmp(word, "screen") == 0 && arg1 != nullptr) {
+    if (strcmp(arg1, "graph") == 0) {
+      bool power = arg2 != nullptr && strcmp(arg2, "power") == 0;
+      uint16_t seconds = arg3 != nullptr ? constrain(atoi(arg3), 1, 3600) : graph_seconds;
+      if (power != graph_power || seconds != graph_seconds) {
+        graph_power = power;
+        graph_seconds = seconds;
+        chart_reset(chart, graph_seconds * 1000UL / CHART_COLUMNS, millis());
+      }
+      chart_invalidate(chart);
+      screen = SCREEN_GRAPH;
+    } else if (strcmp(arg1, "log") == 0) {
+      log_restart = true;
+      screen = SCREEN_LOG;
+    } else {
+      screen = SCREEN_METER;
+    }
+  } else if (strcmp(word, "stat") == 0 && arg1 != nullptr && arg2 != nullptr) {
+    int channel = atoi(arg1);
+    if (channel < 1 || channel > STAT_CHANNELS)
+      return;
+    stat_channel &ch = stat_channels[channel - 1];
+    stat_reset(ch);
+    ch.last_sent = millis();
+    ch.decimation = strcmp(arg2, "off") == 0 ? 0 : constrain(atoi(arg2), 1, 0xffff);
+    ch.min_interval_ms = arg3 != nullptr ? constrain(atoi(arg3), 0, 0xffff) : 0;
+  }
+}
+
+void read_commands() {
+  static char cmd[CMD_BUF_SIZE];
+  static uint8_t len = 0;
+
+  while (Serial.available()) {
+    char c = static_cast<char>(Serial.read());
+    if (c == '\r')
+      continue;
+    if (c == '\n') {
+      cmd[len] = '\0';
+      handle_command(cmd);
+      len = 0;
+    } else if (len < CMD_BUF_SIZE - 1) {
+      cmd[len++] = c;
+    }
+  }
+}
+
+// Sends the tiles of the display buffer that differ from the last mirrored
+// frame, as many as the transmit FIFO takes without blocking; the rest
+// follows on the next calls. Called once per loop pass.
+void mirror_step() {
+  if (!mirror_enabled)
+    return;
+  if (!mirror_busy) {
+    unsigned long now = millis();
+    if (!mirror_resync && now - mirror_last_sent < mirror_interval_ms)
+      return;
+    mirror_last_sent = now;
+    mirror_busy = true;
+    mirror_full = mirror_resync;
+    mirror_resync = false;
+    mirror_tile = 0;
+  }
+
+  const uint8_t *fb = u8g2.getBufferPtr();
+  char buf[MIRROR_FRAME_OVERHEAD + 1 + MIRROR_TILE_COLS * 16];
+  int room = Serial.availableForWrite() - MIRROR_SERIAL_RESERVE;
+  while (mirror_tile < MIRROR_TILE_COLS * MIRROR_TILE_ROWS &&
+         room >= MIRROR_FRAME_OVERHEAD + 16) {
+    uint8_t row = mirror_tile / MIRROR_TILE_COLS;
+    uint16_t mask = 0;
+    char *p = buf + 6;
+    for (uint8_t col = mirror_tile % MIRROR_TILE_COLS;
+         col < MIRROR_TILE_COLS && p - buf + 16 + 2 <= room;
+         col++, mirror_tile++) {
+      uint16_t offset = mirror_tile * 8;
+      // the buffer is in display RAM order, rotated by the start line of
+      // the frame
+      uint8_t ring_row = (row + (u8g2_GetQueueStartLine(&display_queue) >> 3)) %
+                         MIRROR_TILE_ROWS;
+      const uint8_t *tile = fb + (ring_row * MIRROR_TILE_COLS + col) * 8;
+      if (!mirror_full && memcmp(tile, mirror_shadow + offset, 8) == 0)
+        continue;
+      memcpy(mirror_shadow + offset, tile, 8);
+      mask |= 1 << col;
+      for (uint8_t i = 0; i < 8; i++, p += 2)
+        byte2hex(tile[i], p);
+    }
+    if (mask == 0)
+      continue;
+    buf[0] = '#';
+    buf[1] = hexdigit(row);
+    int2hex(mask, buf + 2);
+    p[0] = 28;
+    p[1] = '\n';
+    p[2] = '\0';
+    Serial.print(buf);
+    room -= p + 2 - buf;
+  }
+  if (mirror_tile == MIRROR_TILE_COLS * MIRROR_TILE_ROWS)
+    mirror_busy = false;
+}
+
+// Returns false if the INA226 has not finished a new conversion since the last
+// call.
+bool read_ina(int *shunt, int *millivolt, int *current) {
+  PROFILE_SCOPE(PROFILE_READ_INA);
   float shuntVoltage_mV = 0.0;
   float busVoltage_V = 0.0;
   float current_mA = 0.0;
 
   ina226.readAndClearFlags();
+  if (!ina226.convAlert)
+    return false;
   shuntVoltage_mV = ina226.getShuntVoltage_mV();
   busVoltage_V = ina226.getBusVoltage_V();
   current_mA = ina226.getCurrent_mA();
@@ -166,6 +648,7 @@ void read_ina(int *shunt, int *millivolt, int *current) {
   *shunt = static_cast<int>(shuntVoltage_mV);
   *millivolt = static_cast<int>(busVoltage_V * 1000.0);
   *current = static_cast<int>(current_mA);
+  return true;
 }
 
 uint8_t normalize_volt(int millivolt) {
@@ -245,74 +728,269 @@ void screensaver(int *x, int *y) {
   last_y = *y;
 }
 
-void display(int millivolt, uint8_t volt_norm, int milliamps, int maxcurrent) {
+unsigned long last_voltage_millis = 0;
+
+// True once no voltage has been seen for SCREENSAVER_DELAY.
+bool screensaver_active(uint8_t volt_norm) {
+  if (volt_norm == 0 && last_voltage_millis < millis() - SCREENSAVER_DELAY)
+    return true;
+  if (volt_norm != 0) {
+    last_voltage_millis = millis();
+  }
+  return false;
+}
+
+// True once the screensaver has run for SCREENSAVER_POWER_SAVE.
+bool power_save_due(uint8_t volt_norm) {
+  return screensaver_active(volt_norm) &&
+         millis() - last_voltage_millis >=
+             SCREENSAVER_DELAY + SCREENSAVER_POWER_SAVE;
+}
+
+void draw_screensaver() {
+  int x, y;
+  screensaver(&x, &y);
+  u8g2.drawPixel(x, y);
+}
+
+void display(int millivolt, uint8_t volt_norm, int milliamps, int maxcurrent,
+             int window_min, int window_max) {
+  u8g2.clearBuffer();
+  if (screensaver_active(volt_norm)) {
+    draw_screensaver();
+    return;
+  }
+  // if (volt_norm == 5)
+  //   u8g2.drawStr(10, 17, "5V");
+  // else if (volt_norm == 9)
+  //   u8g2.drawStr(25, 17, "9V");
+  // else if (volt_norm == 15)
+  //   u8g2.drawStr(40, 17, "15V");
+  // else if (volt_norm == 20)
+  //   u8g2.drawStr(55, 17, "20V");
+  // else if (volt_norm == 28)
+  //   u8g2.drawStr(70, 17, "28V");
+  // else if (volt_norm == 36)
+  //   u8g2.drawStr(85, 17, "36V");
+  // else if (volt_norm == 48)
+  //   u8g2.drawStr(100, 17, "48V");
+  meter_draw(u8g2, millivolt, milliamps, maxcurrent, window_min, window_max);
+}
+
+// Graph screen: latest value and full scale / time span on top, the strip
+// chart below. The buffer is not cleared, so only the header and the chart
+// columns that changed are redrawn.
+void display_graph(int millivolt, uint8_t volt_norm, int milliamps) {
   char buf[32];
-  char buf2[32];
-  static unsigned long last_millis = 0;
 
-  u8g2.firstPage();
-  do {
-    u8g2.setFont(u8g2_font_profont17_tr);
-    if (volt_norm == 0 && last_millis < millis() - SCREENSAVER_DELAY) {
-      int x, y;
-      screensaver(&x, &y);
-      u8g2.drawPixel(x, y);
-      continue;
-    }
-    if (volt_norm != 0) {
-      last_millis = millis();
-    }
-    float amps = static_cast<float>(milliamps) / 1000.0F;
-    float volts = static_cast<float>(millivolt) / 1000.0F;
-
-    // if (volt_norm == 5)
-    //   u8g2.drawStr(10, 17, "5V");
-    // else if (volt_norm == 9)
-    //   u8g2.drawStr(25, 17, "9V");
-    // else if (volt_norm == 15)
-    //   u8g2.drawStr(40, 17, "15V");
-    // else if (volt_norm == 20)
-    //   u8g2.drawStr(55, 17, "20V");
-    // else if (volt_norm == 28)
-    //   u8g2.drawStr(70, 17, "28V");
-    // else if (volt_norm == 36)
-    //   u8g2.drawStr(85, 17, "36V");
-    // else if (volt_norm == 48)
-    //   u8g2.drawStr(100, 17, "48V");
-    sprintf(buf, "%0.2fV", volts);
-    u8g2.drawStr(0, 17, buf);
-    sprintf(buf, "%0.2fW", volts * amps);
-    u8g2.drawStr(128 - u8g2.getStrWidth(buf), 17, buf);
-
-    u8g2.setFont(u8g2_font_profont12_tr);
-    sprintf(buf, "%0.3fA", ((float)maxcurrent / 1000.0F));
-    u8g2.drawStr(127 - u8g2.getStrWidth(buf), 32, buf);
-    u8g2.drawLine(127, 33, 127, 35);
-    int bar = (int)((float)128 * ((float)abs(milliamps) / (float)maxcurrent));
-    u8g2.drawLine(0, 34, bar, 34);
-
-    u8g2.setFont(u8g2_font_profont29_tr);
-    sprintf(buf2, "%0.3fA", amps);
-    u8g2.drawStr(128 - u8g2.getStrWidth(buf2), 62, buf2);
-  } while (u8g2.nextPage());
+  if (screensaver_active(volt_norm)) {
+    u8g2.clearBuffer();
+    draw_screensaver();
+    chart_invalidate(chart);
+    return;
+  }
+  chart_draw(chart, u8g2, GRAPH_TOP, u8g2.getDisplayHeight() - GRAPH_TOP);
+
+  u8g2.setDrawColor(0);
+  u8g2.drawBox(0, 0, u8g2.getDisplayWidth(), GRAPH_TOP);
+  u8g2.setDrawColor(1);
+  u8g2.drawHLine(0, GRAPH_TOP - 2, u8g2.getDisplayWidth());
+  u8g2.setFont(FONT_12);
+  // format_milli_auto() may add the 'm' prefix
+  static_assert(font_has_chars(FONT_12_CHARS, "WAm s"), "FONT_12_CHARS");
+  if (graph_power)
+    format_milli(buf, sizeof(buf), milliwatts(millivolt, abs(milliamps)), 2, "W");
+  else
+    format_milli(buf, sizeof(buf), milliamps, 3, "A");
+  u8g2.drawStr(0, 11, buf);
+  size_t len = format_milli_auto(buf, sizeof(buf), chart.scale, 0,
+                                 graph_power ? 'W' : 'A');
+  len += snprintf(buf + len, sizeof(buf) - len, " %us", graph_seconds);
+  u8g2.drawStr(u8g2.getDisplayWidth() - text_width(u8g2, buf, len), 11, buf);
 }
 
-void loop() {
+// Log screen: a line with uptime, voltage and current every LOG_LINE_MS.
+// The display start line moves down by one tile row per line, which scrolls
+// the oldest line (top row) to the bottom; only that row is redrawn, so a
+// scroll step sends 128 bytes instead of the whole buffer. The start line is
+// queued behind that row, so the old line is not shown at the bottom.
+void display_log(int millivolt, uint8_t volt_norm, int milliamps) {
+  static unsigned long last_line = 0;
+  char buf[32];
+
+  if (log_restart) {
+    log_restart = false;
+    u8g2.clearBuffer();
+    last_line = millis() - LOG_LINE_MS;
+  }
+  if (screensaver_active(volt_norm)) {
+    u8g2.clearBuffer();
+    draw_screensaver();
+    return;
+  }
+  if (millis() - last_line < LOG_LINE_MS)
+    return;
+  last_line = millis();
+
+  // the queue is empty, the display shows the start line of the last frame
+  uint8_t y = u8g2.getRingRow(0) * 8;
+  u8g2.queueStartLine(&display_queue, u8g2.getStartLine() + 8);
+  u8g2.setDrawColor(0);
+  u8g2.drawBox(0, y, u8g2.getDisplayWidth(), 8);
+  u8g2.setDrawColor(1);
+  // descenders must not reach into the neighbouring line
+  u8g2.setClipWindow(0, y, u8g2.getDisplayWidth(), y + 8);
+  u8g2.setFont(FONT_10);
+  static_assert(font_has_chars(FONT_10_CHARS, "s V A"), "FONT_10_CHARS");
+  size_t len = snprintf(buf, sizeof(buf), "%5lus ", last_line / 1000);
+  len += format_milli(buf + len, sizeof(buf) - len, millivolt, 2, "V ", 7);
+  format_milli(buf + len, sizeof(buf) - len, milliamps, 3, "A", 7);
+  u8g2.drawStr(0, y + u8g2.getAscent(), buf);
+  u8g2.setMaxClipWindow();
+}
+
+// Polls the INA226 and feeds a finished conversion to the serial stream, the
+// frame window and the graph.
+void acquire() {
+  PROFILE_SCOPE(PROFILE_ACQUIRE);
   int millivolt;
   int shunt;
   int current;
 
-  digitalWrite(MY_BLUE_LED_PIN,
-               HIGH); // Turn the LED on (Note that LOW is the voltage level
-
-  read_ina(&shunt, &millivolt, &current);
+  bus_begin(sensor_bus);
+  bool fresh = read_ina(&shunt, &millivolt, &current);
+  bus_end(sensor_bus);
+  if (!fresh)
+    return;
+  uint32_t sample_us = micros();
   uint8_t volt_norm = normalize_volt(millivolt);
 
-  serial_out(current, millivolt);
+  stream_sample(current, millivolt, sample_us);
+
+  int abs_current = abs(current);
+  if (window.samples == 0 || abs_current < window.min_abs_milliamps)
+    window.min_abs_milliamps = abs_current;
+  if (window.samples == 0 || abs_current > window.max_abs_milliamps)
+    window.max_abs_milliamps = abs_current;
+  window.millivolt = millivolt;
+  window.volt_norm = volt_norm;
+  window.milliamps = current;
+  window.max_current = get_max_current(current, volt_norm);
+  window.samples++;
+  chart_add(chart, graph_power ? milliwatts(millivolt, abs_current) : abs_current,
+            millis());
+  samples_acquired++;
+}
 
-  int max_current = get_max_current(current, volt_norm);
+// Acquires every SAMPLE_POLL_MS. Runs from loop() and, as service of the
+// sensor on the bus, between the transactions of a display transfer.
+void poll_sensor() {
+  static unsigned long last_poll = 0;
+  unsigned long now = millis();
+  if (now - last_poll < SAMPLE_POLL_MS)
+    return;
+  last_poll = now;
+  uint32_t start = micros();
+  acquire();
+  stage_add(acquire_stats, micros() - start);
+}
 
-  display(millivolt, volt_norm, current, max_current);
+// Renders the current screen. Returns false if it was drawn without the
+// buffer, so that there is nothing to queue.
+bool render() {
+  PROFILE_SCOPE(PROFILE_RENDER);
+  // only the log screen scrolls; the start line goes back to 0 once the new
+  // screen is on the display
+  if (screen != SCREEN_LOG)
+    u8g2.queueStartLine(&display_queue, 0);
+#ifdef TILE_READOUT
+  if (screen == SCREEN_METER && !screensaver_active(window.volt_norm)) {
+    // the tiles are drawn right away, for start line 0
+    while (u8g2.queueStep(&display_queue, FRAME_STEP_TILES))
+      ;
+    if (!readout_shown) {
+      readout_invalidate(readout);
+      readout_shown = true;
+    }
+    readout_draw(readout, u8g2.getU8x8(), window.millivolt, window.milliamps,
+                 window.max_current, window.min_abs_milliamps,
+                 window.max_abs_milliamps);
+    window.samples = 0;
+    return false;
+  }
+#endif
+  if (screen == SCREEN_LOG)
+    display_log(window.millivolt, window.volt_norm, window.milliamps);
+  else if (screen == SCREEN_GRAPH)
+    display_graph(window.millivolt, window.volt_norm, window.milliamps);
+  else
+    display(window.millivolt, window.volt_norm, window.milliamps,
+            window.max_current, window.min_abs_milliamps,
+            window.max_abs_milliamps);
+  window.samples = 0;
+  return true;
+}
 
-  delay(50);
+// Queues the rendered buffer for transfer.
+void queue_frame() {
+  PROFILE_SCOPE(PROFILE_QUEUE);
+#ifdef TILE_READOUT
+  if (readout_shown) {
+    readout_shown = false;
+    u8g2.queueAll(&display_queue);
+    return;
+  }
+#endif
+  u8g2.queueUpdate(&display_queue);
+}
+
+void loop() {
+  PROFILE_SCOPE(PROFILE_LOOP);
+  static unsigned long last_frame = 0;
+  static unsigned long last_pass = 0;
+
+  digitalWrite(MY_BLUE_LED_PIN,
+               HIGH); // Turn the LED on (Note that LOW is the voltage level
+
+  read_commands();
+
+  poll_sensor();
+  unsigned long now = millis();
+  if (display_idle)
+    idle_ms += now - last_pass;
+  last_pass = now;
+  // no stats if the display did not get a bus device
+  uint32_t display_bytes = 0;
+  if (display_bus != BUS_NO_DEVICE)
+    display_bytes = bus_device_stats(display_bus).bytes;
+
+  if (display_off && window.volt_norm != 0) {
+    u8g2.setPowerSave(0);
+    display_off = false;
+    last_frame = now - FRAME_INTERVAL_MS; // render right away
+  }
+  if (!u8g2_IsTileQueueEmpty(&display_queue)) {
+    // the next frame is rendered once this one is on the display
+    PROFILE_SCOPE(PROFILE_TRANSFER);
+    uint32_t start = micros();
+    u8g2.queueStep(&display_queue, FRAME_STEP_TILES);
+    stage_add(transfer_stats, micros() - start);
+  } else if (!display_off && now - last_frame >= FRAME_INTERVAL_MS) {
+    last_frame = now;
+    display_idle = screensaver_active(window.volt_norm);
+    if (power_save_due(window.volt_norm)) {
+      // the panel keeps its RAM, so the shadow stays valid
+      u8g2.setPowerSave(1);
+      display_off = true;
+    } else {
+      uint32_t start = micros();
+      if (render())
+        queue_frame();
+      stage_add(render_stats, micros() - start);
+    }
+  }
+  if (display_idle && display_bus != BUS_NO_DEVICE)
+    idle_display_bytes += bus_device_stats(display_bus).bytes - display_bytes;
+  mirror_step();
+  yield();
 }
@@ -0,0 +1,5 @@
+#include "meter_screen.h"
+
+int meter_scale_x(int value, int maxcurrent, int width) {
+  return (int)((float)width * ((float)value / (float)maxcurrent));
+}
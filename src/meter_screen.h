@@ -0,0 +1,50 @@
+#pragma once
+
+#include <U8g2lib.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "fixed_format.h"
+#include "font_subsets.h"
+#include "text_layout.h"
+
+// The meter screen: voltage and power on top, the maximum current with a bar
+// of the current and the marks of the current window below, the current in
+// the large font at the bottom. The firmware draws it in display() (unless
+// the screensaver runs), host/render_bench and host/readout_bench draw the
+// same screen with their displays.
+
+// Column of value on a scale of width pixels for maxcurrent.
+int meter_scale_x(int value, int maxcurrent, int width);
+
+// Draws the screen into the cleared buffer of u8g2. Display is U8G2 or a
+// U8G2_FIXED, whose drawing calls hide those of U8G2 and are not virtual.
+template <class Display>
+void meter_draw(Display &u8g2, int millivolt, int milliamps, int maxcurrent,
+                int window_min, int window_max) {
+  char buf[32];
+
+  u8g2.setFont(FONT_17);
+  static_assert(font_has_chars(FONT_17_CHARS, "VW"), "FONT_17_CHARS");
+  format_milli(buf, sizeof(buf), millivolt, 2, "V");
+  u8g2.drawStr(0, 17, buf);
+  size_t len =
+      format_milli(buf, sizeof(buf), milliwatts(millivolt, milliamps), 2, "W");
+  u8g2.drawStr(128 - text_width(u8g2, buf, len), 17, buf);
+
+  u8g2.setFont(FONT_12);
+  static_assert(font_has_chars(FONT_12_CHARS, "A"), "FONT_12_CHARS");
+  len = format_milli(buf, sizeof(buf), maxcurrent, 3, "A");
+  u8g2.drawStr(127 - text_width(u8g2, buf, len), 32, buf);
+  u8g2.drawLine(127, 33, 127, 35);
+  u8g2.drawLine(0, 34, meter_scale_x(abs(milliamps), maxcurrent, 128), 34);
+  if (window_max > window_min) {
+    u8g2.drawPixel(meter_scale_x(window_min, maxcurrent, 127), 35);
+    u8g2.drawPixel(meter_scale_x(window_max, maxcurrent, 127), 35);
+  }
+
+  u8g2.setFont(FONT_29);
+  static_assert(font_has_chars(FONT_29_CHARS, "A"), "FONT_29_CHARS");
+  len = format_milli(buf, sizeof(buf), milliamps, 3, "A");
+  u8g2.drawStr(128 - text_width(u8g2, buf, len), 62, buf);
+}
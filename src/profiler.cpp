@@ -0,0 +1,81 @@
+#include "profiler.h"
+
+#ifdef PROFILER
+
+#include <string.h>
+
+struct profile_histogram {
+  uint32_t count;
+  uint32_t min, max;
+  uint64_t total;
+  uint16_t buckets[PROFILE_BUCKETS];
+};
+
+static profile_histogram histograms[PROFILE_STAGES];
+
+static const char *const stage_names[PROFILE_STAGES] = {
+    "loop", "acquire", "read_ina", "serial", "render",
+    "format", "text", "queue", "transfer"};
+
+// 0..7 exact, then the two bits below the highest set bit select one of 4
+// buckets per power of two.
+static uint8_t bucket_of(uint32_t ticks) {
+  if (ticks < 8)
+    return ticks;
+  uint8_t exponent = 31 - __builtin_clz(ticks);
+  return 8 + (exponent - 3) * 4 + ((ticks >> (exponent - 2)) & 3);
+}
+
+// Largest value of a bucket.
+static uint32_t bucket_max(uint8_t bucket) {
+  if (bucket < 8)
+    return bucket;
+  uint8_t exponent = 3 + (bucket - 8) / 4;
+  uint8_t sub = (bucket - 8) % 4;
+  return ((5ULL + sub) << (exponent - 2)) - 1;
+}
+
+void profile_add(uint8_t stage, uint32_t ticks) {
+  profile_histogram &h = histograms[stage];
+  if (h.count == 0 || ticks < h.min)
+    h.min = ticks;
+  if (ticks > h.max)
+    h.max = ticks;
+  h.count++;
+  h.total += ticks;
+  uint16_t &bucket = h.buckets[bucket_of(ticks)];
+  if (bucket == UINT16_MAX) {
+    for (uint16_t &b : h.buckets)
+      b = (b + 1) / 2; // a bucket that held samples keeps at least one
+  }
+  bucket++;
+}
+
+const char *profile_stage_name(uint8_t stage) { return stage_names[stage]; }
+
+profile_summary profile_summarize(uint8_t stage) {
+  const profile_histogram &h = histograms[stage];
+  profile_summary s = {h.count, h.min, 0, 0, h.max};
+  if (h.count == 0)
+    return s;
+  s.mean = h.total / h.count;
+
+  uint32_t samples = 0;
+  for (uint16_t b : h.buckets)
+    samples += b;
+  // smallest bucket with at least 99% of the samples at or below it
+  uint32_t rank = samples - samples / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    seen += h.buckets[i];
+    if (seen >= rank) {
+      s.p99 = bucket_max(i) < h.max ? bucket_max(i) : h.max;
+      break;
+    }
+  }
+  return s;
+}
+
+void profile_clear() { memset(histograms, 0, sizeof(histograms)); }
+
+#endif
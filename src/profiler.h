@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+// Latency profile of the stages of loop() (firmware built with -DPROFILER).
+//
+// PROFILE_SCOPE(stage) times the rest of the enclosing block on the CPU cycle
+// counter of the ESP8266 (micros() elsewhere) and adds the time to the
+// histogram of the stage. Scopes may nest; a stage includes the stages it
+// calls. Each histogram has fixed buckets: exact below 8 ticks, then 4 per
+// power of two, so a percentile is off by at most 25%. The counts are 16 bit
+// and are halved together when one would overflow, which keeps the shape of
+// the distribution. Min, mean and max are exact. Without PROFILER,
+// PROFILE_SCOPE compiles to nothing and nothing else is defined.
+
+enum profile_stage : uint8_t {
+  PROFILE_LOOP,     // one pass of loop()
+  PROFILE_ACQUIRE,  // poll and process a sensor sample
+  PROFILE_READ_INA, // INA226 registers over I2C
+  PROFILE_SERIAL,   // sample and statistics frames
+  PROFILE_RENDER,   // drawing a screen
+  PROFILE_FORMAT,   // format_milli()
+  PROFILE_TEXT,     // drawStr() into the buffer
+  PROFILE_QUEUE,    // queueing the changed tiles
+  PROFILE_TRANSFER, // one step of the display transfer
+  PROFILE_STAGES
+};
+
+#ifdef PROFILER
+
+#include <Arduino.h>
+
+#define PROFILE_BUCKETS (8 + 29 * 4) // every 32 bit value
+
+struct profile_summary {
+  uint32_t count;
+  uint32_t min, mean, p99, max; // ticks
+};
+
+static inline uint32_t profile_ticks() {
+#ifdef ESP8266
+  return ESP.getCycleCount();
+#else
+  return micros();
+#endif
+}
+
+static inline uint32_t profile_ticks_per_us() {
+#ifdef ESP8266
+  return ESP.getCpuFreqMHz();
+#else
+  return 1;
+#endif
+}
+
+void profile_add(uint8_t stage, uint32_t ticks);
+const char *profile_stage_name(uint8_t stage);
+profile_summary profile_summarize(uint8_t stage);
+void profile_clear();
+
+struct profile_scope {
+  uint8_t stage;
+  uint32_t start;
+
+  explicit profile_scope(uint8_t stage) : stage(stage), start(profile_ticks()) {}
+  ~profile_scope() { profile_add(stage, profile_ticks() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage)                                                   \
+  profile_scope PROFILE_CONCAT(profile_scope_, __LINE__)(stage)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+
+#endif
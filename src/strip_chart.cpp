@@ -0,0 +1,106 @@
+#include "strip_chart.h"
+
+#include <string.h>
+
+// smallest value at the top of the plot, in milli-units
+#define CHART_MIN_SCALE 10
+
+static void mark_dirty(strip_chart &chart, uint8_t column) {
+  chart.dirty[column >> 3] |= 1 << (column & 7);
+}
+
+static void clear_slot(strip_chart &chart, uint8_t slot) {
+  chart.col_min[slot] = INT32_MAX;
+  chart.col_max[slot] = INT32_MIN;
+}
+
+static void rescan_max(strip_chart &chart) {
+  chart.max_value = 0;
+  for (uint8_t i = 0; i < CHART_COLUMNS; i++) {
+    if (chart.col_max[i] > chart.max_value)
+      chart.max_value = chart.col_max[i];
+  }
+}
+
+// Next 1/2/5 step at or above value.
+static int32_t nice_scale(int32_t value) {
+  int32_t decade = CHART_MIN_SCALE;
+  for (;;) {
+    if (value <= decade)
+      return decade;
+    if (value <= decade * 2)
+      return decade * 2;
+    if (value <= decade * 5 || decade > INT32_MAX / 10)
+      return decade * 5;
+    decade *= 10;
+  }
+}
+
+void chart_reset(strip_chart &chart, uint32_t column_ms, uint32_t now_ms) {
+  for (uint8_t i = 0; i < CHART_COLUMNS; i++)
+    clear_slot(chart, i);
+  chart.head = 0;
+  chart.column_ms = column_ms > 0 ? column_ms : 1;
+  chart.column_start = now_ms;
+  chart.max_value = 0;
+  chart.scale = CHART_MIN_SCALE;
+  chart_invalidate(chart);
+}
+
+void chart_invalidate(strip_chart &chart) {
+  memset(chart.dirty, 0, sizeof(chart.dirty));
+  chart.redraw = true;
+}
+
+// Moves the head over all slots that ended before now_ms. The extremum is
+// only rescanned if the slot that is reused held it.
+static void advance(strip_chart &chart, uint32_t now_ms) {
+  uint8_t steps = 0;
+  while (now_ms - chart.column_start >= chart.column_ms) {
+    if (steps == CHART_COLUMNS) {
+      // everything expired, don't walk the ring again
+      chart.column_start = now_ms;
+      break;
+    }
+    steps++;
+    chart.column_start += chart.column_ms;
+    chart.head = (chart.head + 1) % CHART_COLUMNS;
+    bool held_max = chart.col_max[chart.head] >= chart.max_value;
+    clear_slot(chart, chart.head);
+    if (held_max)
+      rescan_max(chart);
+    mark_dirty(chart, chart.head);
+    mark_dirty(chart, (chart.head + 1) % CHART_COLUMNS);
+  }
+}
+
+void chart_add(strip_chart &chart, int32_t value, uint32_t now_ms) {
+  advance(chart, now_ms);
+  if (value < 0)
+    value = 0;
+  uint8_t slot = chart.head;
+  if (value < chart.col_min[slot])
+    chart.col_min[slot] = value;
+  if (value > chart.col_max[slot])
+    chart.col_max[slot] = value;
+  if (value > chart.max_value)
+    chart.max_value = value;
+  mark_dirty(chart, slot);
+}
+
+bool chart_update_scale(strip_chart &chart) {
+  int32_t scale = nice_scale(chart.max_value);
+  if (scale != chart.scale) {
+    chart.scale = scale;
+    chart.redraw = true;
+  }
+  return chart.redraw;
+}
+
+uint8_t chart_value_to_y(int32_t value, int32_t scale, uint8_t top,
+                         uint8_t height) {
+  if (value > scale)
+    value = scale;
+  return top + height - 1 -
+         static_cast<uint8_t>(static_cast<int64_t>(value) * (height - 1) / scale);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <U8g2lib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Strip chart of a non-negative value (mA or mW) over the last
+// CHART_COLUMNS * column_ms milliseconds, one display column per time slot.
+//
+// The columns are a ring buffer holding the min and max of all samples in
+// their slot. The chart is drawn in sweep mode: column x of the display always
+// shows ring slot x, so a new slot only redraws its own column and the gap
+// in front of it, not the whole history. The full scale is the next 1/2/5
+// step above the largest value in the ring; only a change of the scale
+// redraws all columns.
+
+#define CHART_COLUMNS 128
+
+struct strip_chart {
+  int32_t col_min[CHART_COLUMNS];
+  int32_t col_max[CHART_COLUMNS]; // col_min > col_max: no samples
+  uint8_t head;                   // slot being filled
+  uint32_t column_ms;
+  uint32_t column_start;          // millis() at the start of the head slot
+  int32_t max_value;              // largest col_max in the ring
+  int32_t scale;                  // value at the top of the plot
+  uint8_t dirty[CHART_COLUMNS / 8]; // columns to draw
+  bool redraw;                    // draw everything, e.g. after a scale change
+};
+
+// Empties the chart and starts the head slot at now_ms.
+void chart_reset(strip_chart &chart, uint32_t column_ms, uint32_t now_ms);
+
+// Adds a sample, advancing the head over the slots that ended before now_ms.
+void chart_add(strip_chart &chart, int32_t value, uint32_t now_ms);
+
+// Marks all columns for drawing, e.g. after something else used the buffer.
+void chart_invalidate(strip_chart &chart);
+
+// Sets the scale for the largest value in the ring. Returns true if all
+// columns have to be drawn.
+bool chart_update_scale(strip_chart &chart);
+
+// Row of value in the rows top .. top + height - 1, clamped to the scale.
+uint8_t chart_value_to_y(int32_t value, int32_t scale, uint8_t top,
+                         uint8_t height);
+
+// Draws the changed columns into the rows top .. top + height - 1 of the
+// buffer. Returns true if the whole area was redrawn. Display is U8G2 or a
+// U8G2_FIXED, whose drawing calls hide those of U8G2 and are not virtual.
+template <class Display>
+bool chart_draw(strip_chart &chart, Display &u8g2, uint8_t top, uint8_t height) {
+  bool full = chart_update_scale(chart);
+  if (full) {
+    u8g2.setDrawColor(0);
+    u8g2.drawBox(0, top, CHART_COLUMNS, height);
+    u8g2.setDrawColor(1);
+  }
+
+  uint8_t gap = (chart.head + 1) % CHART_COLUMNS;
+  for (uint8_t x = 0; x < CHART_COLUMNS; x++) {
+    if (!full) {
+      if ((chart.dirty[x >> 3] & (1 << (x & 7))) == 0)
+        continue;
+      u8g2.setDrawColor(0);
+      u8g2.drawVLine(x, top, height);
+      u8g2.setDrawColor(1);
+    }
+    if (x == gap || chart.col_min[x] > chart.col_max[x])
+      continue;
+    uint8_t y0 = chart_value_to_y(chart.col_max[x], chart.scale, top, height);
+    uint8_t y1 = chart_value_to_y(chart.col_min[x], chart.scale, top, height);
+    u8g2.drawVLine(x, y0, y1 - y0 + 1);
+  }
+  memset(chart.dirty, 0, sizeof(chart.dirty));
+  chart.redraw = false;
+  return full;
+}
@@ -0,0 +1,103 @@
+#include "text_layout.h"
+
+#include <string.h>
+
+static font_metrics metrics[LAYOUT_FONTS];
+static uint8_t metrics_next; // replaced next if all are in use
+
+// Starts the table of the current font: no glyphs yet, and the advance if
+// all printable ASCII glyphs of the font have the same.
+static void metrics_start(font_metrics &m, u8g2_t *u) {
+  m.font = u->font;
+  m.advance = 0;
+  m.next = 0;
+  memset(m.glyphs, 0, sizeof(m.glyphs));
+  bool seen = false;
+  for (char c = LAYOUT_FIRST; c <= LAYOUT_LAST; c++) {
+    if (u8g2_font_get_glyph_data(u, c) == NULL)
+      continue;
+    int8_t advance = u8g2_GetGlyphWidth(u, c);
+    if (!seen)
+      m.advance = advance;
+    seen = true;
+    if (advance != m.advance) {
+      m.advance = 0;
+      return;
+    }
+  }
+}
+
+static font_metrics &metrics_of(u8g2_t *u8g2) {
+  const uint8_t *font = u8g2->font;
+  for (font_metrics &m : metrics) {
+    if (m.font == font)
+      return m;
+  }
+  font_metrics &m = metrics[metrics_next];
+  metrics_next = (metrics_next + 1) % LAYOUT_FONTS;
+  metrics_start(m, u8g2);
+  return m;
+}
+
+static void glyph_read(glyph_metrics &g, u8g2_t *u, char c) {
+  g = {c, 0, 0, 0, 0};
+  if (u8g2_font_get_glyph_data(u, c) == NULL)
+    return;
+  // side effects: glyph_x_offset and font_decode.glyph_width
+  g.advance = u8g2_GetGlyphWidth(u, c);
+  g.flags = GLYPH_PRESENT;
+  g.tail = g.advance;
+  if (u->font_decode.glyph_width != 0) {
+    g.flags |= GLYPH_INK;
+    g.tail = u->glyph_x_offset + u->font_decode.glyph_width;
+  }
+  g.lead = u->glyph_x_offset > 0 ? u->glyph_x_offset : 0;
+}
+
+// Metrics of character c, read on the first use; NULL if not printable ASCII
+// or not in the font.
+static const glyph_metrics *glyph_of(font_metrics &m, u8g2_t *u8g2, char c) {
+  if (c < LAYOUT_FIRST || c > LAYOUT_LAST)
+    return NULL;
+  glyph_metrics *g = NULL;
+  for (glyph_metrics &e : m.glyphs) {
+    if (e.encoding == c) {
+      g = &e;
+      break;
+    }
+  }
+  if (g == NULL) {
+    g = &m.glyphs[m.next];
+    m.next = (m.next + 1) % LAYOUT_GLYPHS;
+    glyph_read(*g, u8g2, c);
+  }
+  return (g->flags & GLYPH_PRESENT) ? g : NULL;
+}
+
+u8g2_uint_t text_width(u8g2_t *u8g2, const char *s, size_t len) {
+  if (len == 0)
+    return 0;
+  font_metrics &m = metrics_of(u8g2);
+  if (m.advance == 0)
+    return u8g2_GetStrWidth(u8g2, s);
+  const glyph_metrics *first = glyph_of(m, u8g2, s[0]);
+  if (first == NULL)
+    return u8g2_GetStrWidth(u8g2, s);
+#ifdef U8G2_BALANCED_STR_WIDTH_CALCULATION
+  uint8_t lead = first->lead; // the next lookup may replace the entry
+#endif
+  const glyph_metrics *last = glyph_of(m, u8g2, s[len - 1]);
+  if (last == NULL)
+    return u8g2_GetStrWidth(u8g2, s);
+
+  // advances of all glyphs but the last, in u8g2_uint_t arithmetic like
+  // u8g2_string_width()
+  u8g2_uint_t w = (len - 1) * m.advance;
+  if (!(last->flags & GLYPH_INK))
+    return w + last->advance;
+  w += last->tail;
+#ifdef U8G2_BALANCED_STR_WIDTH_CALCULATION
+  w += lead;
+#endif
+  return w;
+}
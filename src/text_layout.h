@@ -0,0 +1,55 @@
+#pragma once
+
+#include <U8g2lib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// String widths from per-font glyph metrics, for right-aligned fields.
+//
+// getStrWidth() looks up and decodes the header of every glyph of the string
+// on each call. u8g2 measures a string as the advances of all but the last
+// glyph plus the ink of the last one (with U8G2_BALANCED_STR_WIDTH_CALCULATION
+// also the left bearing of the first), so in a monospace font the width of a
+// string of known length needs the metrics of the first and last glyph and a
+// multiplication. These are read the first time text_width() needs them and
+// kept in a table of LAYOUT_GLYPHS entries per font, for the last
+// LAYOUT_FONTS fonts; a full table replaces its oldest entry. The right-
+// aligned fields of the firmware start with a digit or '-' and end with the
+// unit, a dozen entries per font. The result is always that of
+// getStrWidth(); other fonts and strings with a glyph missing from the font
+// fall back to it.
+
+#define LAYOUT_FONTS 4
+#define LAYOUT_GLYPHS 16 // entries per font
+#define LAYOUT_FIRST ' '
+#define LAYOUT_LAST '~'
+
+struct glyph_metrics {
+  char encoding;  // 0: unused
+  int8_t advance; // dx
+  int8_t tail;    // width as last glyph: x offset + glyph width, or dx if empty
+  uint8_t lead;   // added for the first glyph: x offset if positive
+  uint8_t flags;  // GLYPH_PRESENT, GLYPH_INK
+};
+
+#define GLYPH_PRESENT 1
+#define GLYPH_INK 2 // glyph width is not 0
+
+struct font_metrics {
+  const uint8_t *font; // NULL: unused
+  int8_t advance;      // dx of every glyph, 0 if the font is not monospace
+  uint8_t next;        // entry replaced next if all are in use
+  glyph_metrics glyphs[LAYOUT_GLYPHS];
+};
+
+// Width of s in the current font of u8g2, like u8g2_GetStrWidth(u8g2, s).
+// len is strlen(s), e.g. as returned by format_milli(). For a monospace font
+// only the first and last character are looked at, the others must be in the
+// font (see font_has_chars() in font_subsets.h).
+u8g2_uint_t text_width(u8g2_t *u8g2, const char *s, size_t len);
+
+// The same for a U8G2 or U8G2_FIXED display.
+template <class Display>
+u8g2_uint_t text_width(Display &u8g2, const char *s, size_t len) {
+  return text_width(u8g2.getU8g2(), s, len);
+}
@@ -0,0 +1,105 @@
+#include "tile_readout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fixed_format.h"
+
+// the bar row spans the 16 tiles of the 128 pixel wide display
+#define BAR_ROW 4
+#define BAR_TILES 16
+
+void readout_invalidate(tile_readout &readout) {
+  readout.voltage[0] = '\0';
+  readout.power[0] = '\0';
+  readout.max_current[0] = '\0';
+  readout.current[0] = '\0';
+  readout.blank = true;
+  readout.clear = true;
+}
+
+// Draws milli right-aligned in width glyphs at tile x, y, or dashes if it
+// does not fit, so that the field keeps its width.
+static uint8_t draw_field(u8x8_t *u8x8, uint8_t x, uint8_t y, char *shown,
+                          int32_t milli, uint8_t decimals, const char *unit,
+                          uint8_t width) {
+  char buf[READOUT_FIELD_SIZE];
+  if (format_milli(buf, sizeof(buf), milli, decimals, unit, width) != width) {
+    memset(buf, '-', width);
+    buf[width] = '\0';
+  }
+  return u8x8_DrawStringDiff(u8x8, x, y, buf, shown);
+}
+
+// Byte of a column in the bar row, bit n is pixel row 32 + n.
+static uint8_t bar_byte(const tile_readout &readout, int16_t column) {
+  if (readout.blank)
+    return 0;
+  uint8_t bits = 0;
+  if (column <= readout.bar_end)
+    bits |= 0x04;
+  if (column == readout.window_min_x || column == readout.window_max_x)
+    bits |= 0x08;
+  if (column == 127)
+    bits |= 0x0e; // end of the scale
+  return bits;
+}
+
+// Sends the tiles of the bar row that differ between before and after, each
+// run of adjacent tiles with one u8x8_DrawTile().
+static uint8_t draw_bar(u8x8_t *u8x8, const tile_readout &before,
+                        const tile_readout &after) {
+  uint8_t buf[BAR_TILES * 8];
+  uint8_t start = 0, cnt = 0, drawn = 0;
+  for (uint8_t tile = 0; tile <= BAR_TILES; tile++) {
+    bool changed = false;
+    for (uint8_t i = 0; i < 8 && tile < BAR_TILES; i++) {
+      uint8_t bits = bar_byte(after, tile * 8 + i);
+      changed |= bits != bar_byte(before, tile * 8 + i);
+      buf[cnt * 8 + i] = bits;
+    }
+    if (changed) {
+      if (cnt == 0)
+        start = tile;
+      cnt++;
+      drawn++;
+    } else if (cnt > 0) {
+      u8x8_DrawTile(u8x8, start, BAR_ROW, cnt, buf);
+      cnt = 0;
+    }
+  }
+  return drawn;
+}
+
+uint8_t readout_draw(tile_readout &readout, u8x8_t *u8x8, int millivolt,
+                     int milliamps, int maxcurrent, int window_min,
+                     int window_max) {
+  uint8_t drawn = 0;
+  if (readout.clear) {
+    u8x8_ClearDisplay(u8x8);
+    readout.clear = false;
+  }
+
+  u8x8_SetFont(u8x8, u8x8_font_8x13B_1x2_r);
+  drawn += draw_field(u8x8, 0, 0, readout.voltage, millivolt, 2, "V", 6);
+  drawn += draw_field(u8x8, 9, 0, readout.power,
+                      milliwatts(millivolt, milliamps), 2, "W", 7);
+  u8x8_SetFont(u8x8, u8x8_font_chroma48medium8_r);
+  drawn += draw_field(u8x8, 9, 3, readout.max_current, maxcurrent, 3, "A", 7);
+
+  tile_readout before = readout;
+  int bar = maxcurrent > 0 ? 128 * abs(milliamps) / maxcurrent : 0;
+  readout.bar_end = bar < 127 ? bar : 127;
+  readout.window_min_x = -1;
+  readout.window_max_x = -1;
+  if (window_max > window_min && maxcurrent > 0) {
+    readout.window_min_x = 127 * window_min / maxcurrent;
+    readout.window_max_x = 127 * window_max / maxcurrent;
+  }
+  readout.blank = false;
+  drawn += draw_bar(u8x8, before, readout);
+
+  u8x8_SetFont(u8x8, u8x8_font_profont29_2x3_r);
+  drawn += draw_field(u8x8, 2, 5, readout.current, milliamps, 3, "A", 7);
+  return drawn;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <clib/u8x8.h>
+#include <stdint.h>
+
+// The meter screen drawn with the tile API of u8x8 straight to the
+// controller, without the u8g2 buffer (firmware built with -DTILE_READOUT).
+//
+// Each field is right-aligned with a fixed width and remembers the string on
+// the panel, so u8x8_DrawStringDiff() sends only the glyphs that changed; the
+// bar row sends only the tiles that changed. Nothing is cleared except on the
+// first draw after readout_invalidate(). Layout in tiles of 8x8 pixels:
+//
+//   rows 0-1  voltage and power, 8x16 glyphs of u8x8_font_8x13B_1x2_r
+//   row  3    full scale current, 8x8 glyphs of u8x8_font_chroma48medium8_r
+//   row  4    bar and the marks of the current window, pixel rows 33-35 as
+//             on the u8g2 meter screen
+//   rows 5-7  current, 16x24 glyphs of profont29 (pre-tiled u8x8 font)
+//
+// Only the current keeps the profont look of the u8g2 meter screen
+// (meter_draw() of meter_screen.h); the upper two rows use the u8x8 fonts
+// above instead of profont17 and profont12, on the tile grid.
+
+#define READOUT_FIELD_SIZE 8 // longest field (7) and the terminator
+
+struct tile_readout {
+  // strings on the panel, empty if unknown
+  char voltage[READOUT_FIELD_SIZE];
+  char power[READOUT_FIELD_SIZE];
+  char max_current[READOUT_FIELD_SIZE];
+  char current[READOUT_FIELD_SIZE];
+  // bar row on the panel: last column of the bar, window marks (-1: none)
+  int16_t bar_end;
+  int16_t window_min_x, window_max_x;
+  bool blank; // the bar row is empty
+  bool clear; // clear the panel on the next draw
+};
+
+// The panel content is unknown (something else drew on it): the next
+// readout_draw() clears the panel and draws everything.
+void readout_invalidate(tile_readout &readout);
+
+// Draws the values like display() of the u8g2 meter screen. Returns the
+// number of glyphs and bar tiles sent.
+uint8_t readout_draw(tile_readout &readout, u8x8_t *u8x8, int millivolt,
+                     int milliamps, int maxcurrent, int window_min,
+                     int window_max);